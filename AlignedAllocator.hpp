@@ -0,0 +1,51 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/**@brief A standard library allocator returning memory aligned to a cache 
+ *   line.
+ * @author Karl Smith
+ *
+ * Used for the coefficient storage of RateLibrary so that each block of 
+ * parameters starts on a cache line and can be loaded with aligned SIMD 
+ * instructions.
+ */
+template <class T, size_t Alignment = 64>
+class AlignedAllocator {
+	public:
+		typedef T value_type;
+
+		/// @brief Rebinds the allocator to another type.
+		template <class U> struct rebind {typedef AlignedAllocator<U, Alignment> other;};
+
+		AlignedAllocator() {}
+		template <class U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+		/// @brief Allocates aligned storage for n objects.
+		T* allocate(const size_t n) {
+			void *ptr = 0;
+			if (posix_memalign(&ptr, Alignment, n * sizeof(T)) != 0) throw std::bad_alloc();
+			return static_cast<T*>(ptr);
+		}
+
+		/// @brief Releases storage obtained from allocate.
+		void deallocate(T *ptr, size_t) {free(ptr);}
+};
+
+template <class T, class U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+	return true;
+}
+
+template <class T, class U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+	return false;
+}
+
+#endif //ALIGNEDALLOCATOR_H
@@ -0,0 +1,71 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**@brief Runs body(index, thread) for every index in [0, count) on a pool of
+ *   threads.
+ * @author Karl Smith
+ *
+ * The threads take the next index from a shared counter, so uneven work such
+ * as fits needing different numbers of iterations is balanced across the
+ * threads. The thread argument is between 0 and the number of threads used
+ * and identifies storage private to the calling thread, e.g. a fitter:
+ * @code
+ * 	std::vector<ReaclibFitter> fitters(ParallelThreads(0, numJobs));
+ * 	ParallelFor(numJobs, 0, [&](size_t job, unsigned int thread) {
+ * 		fitters[thread].Fit(models[job], t9, rate, sigma, n);
+ * 	});
+ * @endcode
+ * @param[in] count The number of indices.
+ * @param[in] numThreads The number of threads to use. If zero, the number of
+ *   hardware threads is used.
+ * @param[in] body The function called for each index.
+ */
+template <class Body>
+void ParallelFor(const size_t count, const unsigned int numThreads, Body body);
+
+/// @brief Returns the number of threads ParallelFor uses.
+/// @param[in] numThreads The number of threads requested, zero for the number
+///   of hardware threads.
+/// @param[in] count The number of indices, which bounds the number of threads.
+/// @return The number of threads, at least one.
+inline unsigned int ParallelThreads(const unsigned int numThreads,
+	const size_t count
+) {
+	unsigned int threads = numThreads ? numThreads : std::thread::hardware_concurrency();
+	if (threads > count) threads = count;
+	return threads ? threads : 1;
+}
+
+/**With a single thread the body is run on the calling thread, so the serial
+ * case has no threading overhead.
+ */
+template <class Body>
+inline void ParallelFor(const size_t count, const unsigned int numThreads,
+	Body body
+) {
+	const unsigned int threads = ParallelThreads(numThreads, count);
+	if (threads == 1) {
+		for (size_t i = 0; i < count; i++) body(i, 0u);
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	auto worker = [&](const unsigned int thread) {
+		for (size_t i = next++; i < count; i = next++) body(i, thread);
+	};
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (unsigned int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+	worker(0);
+	for (size_t t = 0; t < pool.size(); t++) pool[t].join();
+}
+
+#endif //PARALLELFOR_H
@@ -0,0 +1,123 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "RateLibrary.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+RateLibrary::RateLibrary() :
+	rateOffsets_(1, 0)
+{
+
+}
+
+/**The parameters of each set are appended to the coefficient columns. Narrow
+ * resonance sets are stored with their explicit a2 through a6 values, so 
+ * every set is evaluated by the same product; the set types are kept to 
+ * rebuild the rate for evaluation with ReaclibKernel or ReaclibRate. The 
+ * resonance flags are kept so that a parsed database is written back 
+ * unchanged, as the flag of a set can not be derived from its type.
+ */
+size_t RateLibrary::AddRate(const double *par, const unsigned int numSets,
+	const ReaclibKernel::SetType *setTypes, const double t9Min, const double t9Max,
+	const ReactionInfo *info, const char *resonanceFlags
+) {
+	for (unsigned int i = 0; i < numSets; i++) {
+		for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+			columns_[j].push_back(par[7 * i + j]);
+		}
+		setTypes_.push_back(setTypes ? setTypes[i] : ReaclibKernel::kGeneral);
+		if (resonanceFlags) resonanceFlags_.push_back(resonanceFlags[i]);
+		else {
+			const bool resonance = setTypes && setTypes[i] == ReaclibKernel::kNarrowResonance;
+			resonanceFlags_.push_back(resonance ? 'r' : 'n');
+		}
+	}
+	rateOffsets_.push_back(rateOffsets_.back() + numSets);
+	t9Min_.push_back(t9Min);
+	t9Max_.push_back(t9Max);
+	if (info) reactions_.push_back(*info);
+	else {
+		ReactionInfo empty;
+		memset(&empty, 0, sizeof(empty));
+		reactions_.push_back(empty);
+	}
+	return GetNumRates() - 1;
+}
+
+void RateLibrary::Clear() {
+	for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+		columns_[j].clear();
+	}
+	setTypes_.clear();
+	resonanceFlags_.clear();
+	rateOffsets_.assign(1, 0);
+	t9Min_.clear();
+	t9Max_.clear();
+	reactions_.clear();
+}
+
+void RateLibrary::GetParameters(const size_t rateId, double *par) const {
+	for (uint32_t set = rateOffsets_[rateId]; set < rateOffsets_[rateId + 1]; set++) {
+		for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+			*par++ = columns_[j][set];
+		}
+	}
+}
+
+RateLibraryView RateLibrary::GetView() const {
+	RateLibraryView view;
+	view.numRates = GetNumRates();
+	view.numSets = GetNumSets();
+	for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+		view.columns[j] = columns_[j].data();
+	}
+	view.setTypes = setTypes_.data();
+	view.resonanceFlags = resonanceFlags_.data();
+	view.rateOffsets = rateOffsets_.data();
+	view.t9Min = t9Min_.data();
+	view.t9Max = t9Max_.data();
+	view.reactions = reactions_.data();
+	return view;
+}
+
+/**The sets are processed in chunks. For each chunk the exponents of the sets
+ * are accumulated column by column from the temperature basis, which 
+ * vectorizes across sets, the exponential is applied with ReaclibKernel::Exp
+ * and the results are summed into the rate owning each set. Rates are 
+ * evaluated regardless of their validity range.
+ */
+void RateLibraryView::Evaluate(const TemperatureBasis &basis, double *rates,
+	const ReaclibKernel::Accuracy accuracy
+) const {
+	typedef TemperatureBasis B;
+	//The number of sets processed per pass through the exponential.
+	const size_t kChunkSize = 256;
+	std::fill(rates, rates + numRates, 0.);
+
+	double exponents[kChunkSize];
+	size_t rate = 0;
+	for (size_t start = 0; start < numSets; start += kChunkSize) {
+		const size_t chunkSize = std::min(kChunkSize, numSets - start);
+		const double *a0 = columns[0] + start, *a1 = columns[1] + start;
+		const double *a2 = columns[2] + start, *a3 = columns[3] + start;
+		const double *a4 = columns[4] + start, *a5 = columns[5] + start;
+		const double *a6 = columns[6] + start;
+		for (size_t i = 0; i < chunkSize; i++) {
+			exponents[i] = a0[i] + a1[i] * basis[B::kInverse] 
+				+ a2[i] * basis[B::kInverseThird] + a3[i] * basis[B::kThird] 
+				+ a4[i] * basis[B::kLinear] + a5[i] * basis[B::kFiveThirds] 
+				+ a6[i] * basis[B::kLog];
+		}
+
+		ReaclibKernel::Exp(exponents, exponents, chunkSize, accuracy);
+
+		//Add each set to its rate, skipping over rates without sets.
+		for (size_t i = 0; i < chunkSize; i++) {
+			while (start + i >= rateOffsets[rate + 1]) rate++;
+			rates[rate] += exponents[i];
+		}
+	}
+}
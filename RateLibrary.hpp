@@ -0,0 +1,213 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef RATELIBRARY_H
+#define RATELIBRARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "ReaclibKernel.hpp"
+#include "TemperatureBasis.hpp"
+
+/**@brief Identifies the reaction a rate in a RateLibrary belongs to.
+ *
+ * The fields follow the set label of the REACLIB format. The structure has a
+ * fixed size so that it can be stored in binary libraries as is.
+ */
+struct ReactionInfo {
+	/// The maximum number of nuclides in a REACLIB reaction.
+	static const unsigned int kMaxNuclides = 6;
+
+	char nuclides[kMaxNuclides][6]; ///< Null terminated nuclide names, e.g. "he4".
+	char label[5]; ///< Null terminated label of the source, e.g. "nacr".
+	uint8_t chapter; ///< The REACLIB chapter, determining reactants and products.
+	char reverse; ///< 'v' for a rate computed from detailed balance.
+	char padding[5]; ///< Unused, zero.
+	double qValue; ///< The reaction Q value in MeV.
+};
+
+/**@brief The arrays describing the rates of a library, without ownership.
+ *
+ * A view either refers to the storage of a RateLibrary or to a memory mapped
+ * RateLibraryFile, so that both are evaluated by the same code.
+ */
+struct RateLibraryView {
+	size_t numRates; ///< The number of rates.
+	size_t numSets; ///< The total number of sets.
+	const double *columns[TemperatureBasis::kNumTerms]; ///< The coefficients a0 through a6 of every set.
+	const uint8_t *setTypes; ///< The ReaclibKernel::SetType of every set.
+	const char *resonanceFlags; ///< The REACLIB flag of every set, 'n', 'r', 'w' or 's'.
+	const uint32_t *rateOffsets; ///< The first set of each rate followed by numSets.
+	const double *t9Min; ///< The lowest valid temperature of each rate.
+	const double *t9Max; ///< The highest valid temperature of each rate.
+	const ReactionInfo *reactions; ///< The reaction of each rate.
+
+	/// @brief Evaluates every rate.
+	/// @param[in] basis The temperature terms.
+	/// @param[out] rates Array of numRates values filled with the rates.
+	/// @param[in] accuracy The accuracy of the exponential.
+	void Evaluate(const TemperatureBasis &basis, double *rates, 
+		const ReaclibKernel::Accuracy accuracy = ReaclibKernel::kFull) const;
+};
+
+/**@brief A compact collection of REACLIB rates evaluated together at a 
+ *   single temperature.
+ * @author Karl Smith
+ *
+ * The library holds the sets of every rate in a structure of arrays: one 
+ * cache aligned column for each of the coefficients a0 through a6, columns 
+ * of set types and resonance flags, the offset of the first set of each rate
+ * and the range of T9 over which each rate is valid. A set costs 58 bytes,
+ * seven coefficients, its type and its flag, so a production library of 
+ * tens of thousands of rates fits in a few MB instead of carrying a 
+ * ReaclibRate, and with it a TF1, per rate.
+ *
+ * All rates are evaluated at once by multiplying the coefficient columns 
+ * with the temperature basis, taking the vectorized exponential of the 
+ * resulting set exponents and summing the sets belonging to each rate, e.g. 
+ * in every zone of a hydrodynamics step:
+ * @code
+ * 	std::vector<double> lambda(library.GetNumRates());
+ * 	library.Evaluate(t9, lambda.data());
+ * @endcode
+ */
+class RateLibrary {
+	public:
+		/// A column of coefficients, one entry per set.
+		typedef std::vector<double, AlignedAllocator<double> > Column;
+
+		/// @brief Default constructor.
+		RateLibrary();
+
+		/// @brief Adds a rate to the library.
+		/// @param[in] par The 7 * numSets REACLIB parameters of the rate.
+		/// @param[in] numSets The number of sets in the rate.
+		/// @param[in] setTypes The structural type of each set. If null every
+		///   set is ReaclibKernel::kGeneral.
+		/// @param[in] t9Min The lowest temperature the rate is valid for.
+		/// @param[in] t9Max The highest temperature the rate is valid for.
+		/// @param[in] info The reaction the rate describes. If null the 
+		///   reaction information is zeroed.
+		/// @param[in] resonanceFlags The REACLIB flag of each set. If null 
+		///   narrow resonance sets are flagged 'r' and all others 'n'.
+		/// @return The index of the rate in the library.
+		size_t AddRate(const double *par, const unsigned int numSets, 
+			const ReaclibKernel::SetType *setTypes = 0, 
+			const double t9Min = 0.01, const double t9Max = 10,
+			const ReactionInfo *info = 0, const char *resonanceFlags = 0
+		);
+
+		/// @brief Releases all rates.
+		void Clear();
+
+		/// @brief Returns the number of rates in the library.
+		size_t GetNumRates() const {return rateOffsets_.size() - 1;}
+
+		/// @brief Returns the total number of sets in the library.
+		size_t GetNumSets() const {return setTypes_.size();}
+
+		/// @brief Returns the number of sets in the specified rate.
+		/// @param[in] rateId The index of the rate.
+		unsigned int GetNumSets(const size_t rateId) const {
+			return rateOffsets_[rateId + 1] - rateOffsets_[rateId];
+		}
+
+		/// @brief Returns the index of the first set of the specified rate.
+		/// @param[in] rateId The index of the rate.
+		uint32_t GetSetOffset(const size_t rateId) const {
+			return rateOffsets_[rateId];
+		}
+
+		/// @brief Copies the parameters of a rate in the ReaclibRate layout.
+		/// @param[in] rateId The index of the rate.
+		/// @param[out] par Array of 7 * GetNumSets(rateId) parameters.
+		void GetParameters(const size_t rateId, double *par) const;
+
+		/// @brief Returns the coefficient column for a parameter index.
+		/// @param[in] term The parameter index within a set, 0 through 6.
+		const Column& GetColumn(const unsigned int term) const {
+			return columns_[term];
+		}
+
+		/// @brief Returns the structural type of a set.
+		/// @param[in] rateId The index of the rate.
+		/// @param[in] setId The index of the set within the rate.
+		ReaclibKernel::SetType GetSetType(const size_t rateId, 
+			const unsigned int setId) const {
+			return static_cast<ReaclibKernel::SetType>(
+				setTypes_[rateOffsets_[rateId] + setId]);
+		}
+
+		/// @brief Returns the REACLIB flag of a set, 'n', 'r', 'w' or 's'.
+		/// @param[in] rateId The index of the rate.
+		/// @param[in] setId The index of the set within the rate.
+		char GetResonanceFlag(const size_t rateId, const unsigned int setId) const {
+			return resonanceFlags_[rateOffsets_[rateId] + setId];
+		}
+
+		/// @brief Returns the reaction a rate describes.
+		/// @param[in] rateId The index of the rate.
+		const ReactionInfo& GetReactionInfo(const size_t rateId) const {
+			return reactions_[rateId];
+		}
+
+		/// @brief Returns the range of temperatures a rate is valid for.
+		/// @param[in] rateId The index of the rate.
+		/// @param[out] t9Min The lowest valid temperature.
+		/// @param[out] t9Max The highest valid temperature.
+		void GetValidityRange(const size_t rateId, double &t9Min, 
+			double &t9Max) const {
+			t9Min = t9Min_[rateId];
+			t9Max = t9Max_[rateId];
+		}
+
+		/// @brief Returns true if the temperature is within the validity 
+		///   range of the rate.
+		/// @param[in] rateId The index of the rate.
+		/// @param[in] t9 The temperature in GK.
+		bool IsValid(const size_t rateId, const double t9) const {
+			return t9 >= t9Min_[rateId] && t9 <= t9Max_[rateId];
+		}
+
+		/// @brief Returns the arrays of the library. The view is invalidated
+		///   when rates are added.
+		RateLibraryView GetView() const;
+
+		/// @brief Evaluates every rate in the library.
+		/// @param[in] basis The temperature terms.
+		/// @param[out] rates Array of GetNumRates() values filled with the rates.
+		/// @param[in] accuracy The accuracy of the exponential.
+		void Evaluate(const TemperatureBasis &basis, double *rates, 
+			const ReaclibKernel::Accuracy accuracy = ReaclibKernel::kFull
+		) const {
+			GetView().Evaluate(basis, rates, accuracy);
+		}
+
+		/// @brief Evaluates every rate in the library.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[out] rates Array of GetNumRates() values filled with the rates.
+		/// @param[in] accuracy The accuracy of the exponential.
+		void Evaluate(const double t9, double *rates, 
+			const ReaclibKernel::Accuracy accuracy = ReaclibKernel::kFull
+		) const {
+			Evaluate(TemperatureBasis(t9), rates, accuracy);
+		}
+
+	private:
+		///The coefficients a0 through a6 of every set.
+		Column columns_[TemperatureBasis::kNumTerms];
+		///The ReaclibKernel::SetType of every set.
+		std::vector<uint8_t> setTypes_;
+		///The REACLIB flag of every set.
+		std::vector<char> resonanceFlags_;
+		///The first set of each rate followed by the total number of sets.
+		std::vector<uint32_t> rateOffsets_;
+		std::vector<double> t9Min_; ///< The lowest valid temperature of each rate.
+		std::vector<double> t9Max_; ///< The highest valid temperature of each rate.
+		std::vector<ReactionInfo> reactions_; ///< The reaction of each rate.
+};
+
+#endif //RATELIBRARY_H
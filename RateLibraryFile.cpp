@@ -0,0 +1,259 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "RateLibraryFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	const char kMagic[8] = {'R', 'E', 'A', 'C', 'L', 'I', 'B', '\0'};
+	const uint32_t kByteOrder = 0x01020304;
+	///The alignment of each array within the file.
+	const uint64_t kAlignment = 64;
+
+	static_assert(sizeof(ReactionInfo) == 56, 
+		"ReactionInfo must keep its size to be stored in binary libraries.");
+
+	uint64_t Align(const uint64_t offset) {
+		return (offset + kAlignment - 1) / kAlignment * kAlignment;
+	}
+
+	/**Pads the file with zeros from the current position to the offset.
+	 */
+	bool Pad(FILE *file, uint64_t &position, const uint64_t offset) {
+		static const char zeros[kAlignment] = {0};
+		if (fwrite(zeros, 1, offset - position, file) != offset - position) return false;
+		position = offset;
+		return true;
+	}
+
+	/**Writes the same array of each view one after the other starting at the
+	 * offset. The array is selected by its byte offset within the view.
+	 */
+	template <class T>
+	bool WriteArrays(FILE *file, uint64_t &position, const uint64_t offset,
+		const RateLibraryView *views, const size_t numViews, 
+		const T* RateLibraryView::*array, const bool perSet
+	) {
+		if (!Pad(file, position, offset)) return false;
+		for (size_t v = 0; v < numViews; v++) {
+			const uint64_t count = perSet ? views[v].numSets : views[v].numRates;
+			if (count && fwrite(views[v].*array, sizeof(T), count, file) != count) {
+				return false;
+			}
+			position += count * sizeof(T);
+		}
+		return true;
+	}
+
+	/**Returns true if an array of the given size at the offset lies within 
+	 * the file and is aligned.
+	 */
+	bool IsInside(const uint64_t offset, const uint64_t size, const uint64_t fileSize) {
+		return offset % kAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+	}
+}
+
+RateLibraryFile::RateLibraryFile() :
+	data_(0),
+	size_(0)
+{
+	memset(&view_, 0, sizeof(view_));
+}
+
+RateLibraryFile::~RateLibraryFile() {
+	Close();
+}
+
+bool RateLibraryFile::Write(const RateLibraryView &library, const char *filename) {
+	return Write(&library, 1, filename);
+}
+
+/**The layout is computed from the total number of rates and sets, the 
+ * header is written and then each array of every library is streamed to its
+ * aligned offset. The set offsets of later libraries are shifted by the 
+ * number of sets before them.
+ */
+bool RateLibraryFile::Write(const RateLibraryView *libraries, 
+	const size_t numLibraries, const char *filename
+) {
+	uint64_t numRates = 0, numSets = 0;
+	for (size_t v = 0; v < numLibraries; v++) {
+		numRates += libraries[v].numRates;
+		numSets += libraries[v].numSets;
+	}
+	if (numSets >= UINT32_MAX || numRates >= UINT32_MAX) return false;
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.byteOrder = kByteOrder;
+	header.numRates = numRates;
+	header.numSets = numSets;
+
+	uint64_t offset = Align(sizeof(Header));
+	for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+		header.columnOffsets[j] = offset;
+		offset = Align(offset + numSets * sizeof(double));
+	}
+	header.setTypeOffset = offset;
+	offset = Align(offset + numSets * sizeof(uint8_t));
+	header.resonanceFlagOffset = offset;
+	offset = Align(offset + numSets * sizeof(char));
+	header.rateOffsetOffset = offset;
+	offset = Align(offset + (numRates + 1) * sizeof(uint32_t));
+	header.t9MinOffset = offset;
+	offset = Align(offset + numRates * sizeof(double));
+	header.t9MaxOffset = offset;
+	offset = Align(offset + numRates * sizeof(double));
+	header.reactionOffset = offset;
+	header.fileSize = offset + numRates * sizeof(ReactionInfo);
+
+	FILE *file = fopen(filename, "wb");
+	if (!file) return false;
+	uint64_t position = sizeof(header);
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (unsigned int j = 0; j < TemperatureBasis::kNumTerms && success; j++) {
+		//Columns are written by hand as they are an array member of the view.
+		success = Pad(file, position, header.columnOffsets[j]);
+		for (size_t v = 0; v < numLibraries && success; v++) {
+			const size_t count = libraries[v].numSets;
+			success = !count || fwrite(libraries[v].columns[j], sizeof(double), 
+				count, file) == count;
+			position += count * sizeof(double);
+		}
+	}
+	success = success && WriteArrays(file, position, header.setTypeOffset, 
+		libraries, numLibraries, &RateLibraryView::setTypes, true);
+	success = success && WriteArrays(file, position, header.resonanceFlagOffset, 
+		libraries, numLibraries, &RateLibraryView::resonanceFlags, true);
+
+	//The set offsets of each library are shifted by the sets before it.
+	success = success && Pad(file, position, header.rateOffsetOffset);
+	uint32_t firstSet = 0;
+	for (size_t v = 0; v < numLibraries && success; v++) {
+		for (size_t r = 0; r < libraries[v].numRates && success; r++) {
+			const uint32_t rateOffset = firstSet + libraries[v].rateOffsets[r];
+			success = fwrite(&rateOffset, sizeof(rateOffset), 1, file) == 1;
+		}
+		firstSet += libraries[v].numSets;
+		position += libraries[v].numRates * sizeof(uint32_t);
+	}
+	success = success && fwrite(&firstSet, sizeof(firstSet), 1, file) == 1;
+	position += sizeof(firstSet);
+
+	success = success && WriteArrays(file, position, header.t9MinOffset, 
+		libraries, numLibraries, &RateLibraryView::t9Min, false);
+	success = success && WriteArrays(file, position, header.t9MaxOffset, 
+		libraries, numLibraries, &RateLibraryView::t9Max, false);
+	success = success && WriteArrays(file, position, header.reactionOffset, 
+		libraries, numLibraries, &RateLibraryView::reactions, false);
+	if (fclose(file) != 0) success = false;
+	return success;
+}
+
+/**The existing file is mapped and the combined library is written to a 
+ * temporary file next to it, which then replaces it, so readers never see a
+ * partially written library. Every array is copied, as the arrays of the new
+ * rates must follow those of the existing ones. If the file does not exist 
+ * yet it is created with only the new rates.
+ */
+bool RateLibraryFile::RewriteAppended(const char *filename, const RateLibraryView &rates) {
+	RateLibraryFile existing;
+	if (access(filename, F_OK) != 0) return Write(rates, filename);
+	if (!existing.Open(filename)) return false;
+
+	const RateLibraryView libraries[2] = {existing.GetView(), rates};
+	char temporary[4096];
+	if (snprintf(temporary, sizeof(temporary), "%s.tmp", filename) 
+		>= (int) sizeof(temporary)) {
+		return false;
+	}
+	if (!Write(libraries, 2, temporary)) {
+		remove(temporary);
+		return false;
+	}
+	existing.Close();
+	return rename(temporary, filename) == 0;
+}
+
+/**The file is mapped read only and shared. The header is validated against
+ * the magic string, version, byte order and the size of the file before the
+ * view is pointed at the arrays in the mapping. The set offsets must then 
+ * start at zero, never decrease and end at the number of sets, and every set
+ * type must be known. A file failing any check is closed.
+ */
+bool RateLibraryFile::Open(const char *filename) {
+	Close();
+	const int fd = open(filename, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size < (off_t) sizeof(Header)) {
+		close(fd);
+		return false;
+	}
+	void *data = mmap(0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return false;
+	data_ = data;
+	size_ = status.st_size;
+
+	const Header &header = *static_cast<const Header*>(data_);
+	const uint64_t numRates = header.numRates, numSets = header.numSets;
+	bool valid = memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 
+		&& header.version == kVersion && header.byteOrder == kByteOrder 
+		&& header.fileSize == size_ && numSets < UINT32_MAX && numRates < UINT32_MAX;
+	for (unsigned int j = 0; j < TemperatureBasis::kNumTerms && valid; j++) {
+		valid = IsInside(header.columnOffsets[j], numSets * sizeof(double), size_);
+	}
+	valid = valid && IsInside(header.setTypeOffset, numSets, size_)
+		&& IsInside(header.resonanceFlagOffset, numSets, size_)
+		&& IsInside(header.rateOffsetOffset, (numRates + 1) * sizeof(uint32_t), size_)
+		&& IsInside(header.t9MinOffset, numRates * sizeof(double), size_)
+		&& IsInside(header.t9MaxOffset, numRates * sizeof(double), size_)
+		&& IsInside(header.reactionOffset, numRates * sizeof(ReactionInfo), size_);
+	if (!valid) {
+		Close();
+		return false;
+	}
+
+	const char *base = static_cast<const char*>(data_);
+	view_.numRates = numRates;
+	view_.numSets = numSets;
+	for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+		view_.columns[j] = reinterpret_cast<const double*>(base + header.columnOffsets[j]);
+	}
+	view_.setTypes = reinterpret_cast<const uint8_t*>(base + header.setTypeOffset);
+	view_.resonanceFlags = base + header.resonanceFlagOffset;
+	view_.rateOffsets = reinterpret_cast<const uint32_t*>(base + header.rateOffsetOffset);
+	view_.t9Min = reinterpret_cast<const double*>(base + header.t9MinOffset);
+	view_.t9Max = reinterpret_cast<const double*>(base + header.t9MaxOffset);
+	view_.reactions = reinterpret_cast<const ReactionInfo*>(base + header.reactionOffset);
+
+	//The sets of each rate must follow those of the previous rate and lie 
+	//within the columns, otherwise evaluation would read beyond them.
+	valid = view_.rateOffsets[0] == 0 && view_.rateOffsets[numRates] == numSets;
+	for (uint64_t r = 0; r < numRates && valid; r++) {
+		valid = view_.rateOffsets[r] <= view_.rateOffsets[r + 1];
+	}
+	for (uint64_t i = 0; i < numSets && valid; i++) {
+		valid = view_.setTypes[i] <= ReaclibKernel::kNarrowResonance;
+	}
+	if (!valid) Close();
+	return valid;
+}
+
+void RateLibraryFile::Close() {
+	if (data_) munmap(data_, size_);
+	data_ = 0;
+	size_ = 0;
+	memset(&view_, 0, sizeof(view_));
+}
@@ -0,0 +1,144 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef RATELIBRARYFILE_H
+#define RATELIBRARYFILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "RateLibrary.hpp"
+#include "TemperatureBasis.hpp"
+
+/**@brief A compiled rate library stored in a binary file that is memory 
+ *   mapped and evaluated in place.
+ * @author Karl Smith
+ *
+ * The file consists of a fixed header followed by the arrays of a 
+ * RateLibrary in native byte order, each starting on a 64 byte boundary:
+ * the coefficient columns a0 through a6, the set types, the resonance flags,
+ * the set offsets of each rate, the validity ranges and the ReactionInfo of each rate. The 
+ * header records a format version, a byte order mark and the offset of each
+ * array, all of which are checked when the file is opened.
+ *
+ * The mapping is read only and shared, so every process on a node using the
+ * same library shares a single copy through the page cache and no parsing is
+ * done at start up:
+ * @code
+ * 	RateLibraryFile::Write(library, "network.rlib");
+ * 	...
+ * 	RateLibraryFile file;
+ * 	if (file.Open("network.rlib")) file.Evaluate(t9, lambda);
+ * @endcode
+ */
+class RateLibraryFile {
+	public:
+		/// The version of the format written by this class.
+		static const uint32_t kVersion = 2;
+
+		/// @brief The header at the start of the file.
+		struct Header {
+			char magic[8]; ///< "REACLIB" followed by a null character.
+			uint32_t version; ///< The format version.
+			uint32_t byteOrder; ///< 0x01020304 in the byte order of the writer.
+			uint64_t numRates; ///< The number of rates.
+			uint64_t numSets; ///< The total number of sets.
+			uint64_t columnOffsets[TemperatureBasis::kNumTerms]; ///< The offset of each coefficient column.
+			uint64_t setTypeOffset; ///< The offset of the set types.
+			uint64_t resonanceFlagOffset; ///< The offset of the resonance flags.
+			uint64_t rateOffsetOffset; ///< The offset of the set offsets of each rate.
+			uint64_t t9MinOffset; ///< The offset of the lowest valid temperatures.
+			uint64_t t9MaxOffset; ///< The offset of the highest valid temperatures.
+			uint64_t reactionOffset; ///< The offset of the reaction information.
+			uint64_t fileSize; ///< The total size of the file.
+		};
+
+		/// @brief Default constructor.
+		RateLibraryFile();
+
+		/// @brief Unmaps the file.
+		~RateLibraryFile();
+
+		/// @brief Writes a library to a binary file.
+		/// @param[in] library The library to write.
+		/// @param[in] filename The path of the file to create.
+		/// @return True if the file was written successfully.
+		static bool Write(const RateLibraryView &library, const char *filename);
+
+		/// @copydoc Write(const RateLibraryView&, const char*)
+		static bool Write(const RateLibrary &library, const char *filename) {
+			return Write(library.GetView(), filename);
+		}
+
+		/// @brief Writes the concatenation of several libraries to a binary 
+		///   file.
+		/// @param[in] libraries The libraries to write, in order.
+		/// @param[in] numLibraries The number of libraries.
+		/// @param[in] filename The path of the file to create.
+		/// @return True if the file was written successfully.
+		static bool Write(const RateLibraryView *libraries, 
+			const size_t numLibraries, const char *filename);
+
+		/// @brief Rewrites a binary library file with rates added after its 
+		///   own, creating it if needed. Each array of the format is 
+		///   contiguous, so the whole file is rewritten and the cost grows 
+		///   with its size; to combine many libraries pass them all to 
+		///   Write(const RateLibraryView*, const size_t, const char*) instead.
+		/// @param[in] filename The path to the file.
+		/// @param[in] rates The rates to add.
+		/// @return True if the file was replaced successfully.
+		static bool RewriteAppended(const char *filename, const RateLibraryView &rates);
+
+		/// @copydoc RewriteAppended(const char*, const RateLibraryView&)
+		static bool RewriteAppended(const char *filename, const RateLibrary &rates) {
+			return RewriteAppended(filename, rates.GetView());
+		}
+
+		/// @brief Maps a binary library file.
+		/// @param[in] filename The path to the file.
+		/// @return False if the file could not be mapped or is not a valid 
+		///   library of this version and byte order.
+		bool Open(const char *filename);
+
+		/// @brief Unmaps the file.
+		void Close();
+
+		/// @brief Returns true if a file is mapped.
+		bool IsOpen() const {return data_ != 0;}
+
+		/// @brief Returns the arrays of the mapped library.
+		const RateLibraryView& GetView() const {return view_;}
+
+		/// @brief Returns the number of rates in the library.
+		size_t GetNumRates() const {return view_.numRates;}
+
+		/// @brief Evaluates every rate in the library.
+		/// @param[in] basis The temperature terms.
+		/// @param[out] rates Array of GetNumRates() values filled with the rates.
+		/// @param[in] accuracy The accuracy of the exponential.
+		void Evaluate(const TemperatureBasis &basis, double *rates, 
+			const ReaclibKernel::Accuracy accuracy = ReaclibKernel::kFull
+		) const {
+			view_.Evaluate(basis, rates, accuracy);
+		}
+
+		/// @brief Evaluates every rate in the library.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[out] rates Array of GetNumRates() values filled with the rates.
+		/// @param[in] accuracy The accuracy of the exponential.
+		void Evaluate(const double t9, double *rates, 
+			const ReaclibKernel::Accuracy accuracy = ReaclibKernel::kFull
+		) const {
+			view_.Evaluate(TemperatureBasis(t9), rates, accuracy);
+		}
+
+	private:
+		RateLibraryFile(const RateLibraryFile&) = delete;
+		RateLibraryFile& operator=(const RateLibraryFile&) = delete;
+
+		void *data_; ///< The start of the mapping.
+		size_t size_; ///< The length of the mapping.
+		RateLibraryView view_; ///< The arrays within the mapping.
+};
+
+#endif //RATELIBRARYFILE_H
@@ -0,0 +1,69 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "RateTable.hpp"
+
+#include <cmath>
+#include <cstring>
+
+RateTable::RateTable() :
+	offsets_(1, 0)
+{
+
+}
+
+/**The uncertainty of the rate is computed as the point is added so that
+ * fits read it directly.
+ */
+void RateTable::AddPoint(const double t9, const double rate,
+	const double factor
+) {
+	t9_.push_back(t9);
+	rate_.push_back(rate);
+	factor_.push_back(factor);
+	sigma_.push_back(factor > 1 ? rate * log(factor) : 0);
+}
+
+/**A table has uncertainties only if every point has a factor uncertainty
+ * above one, otherwise the fit weights all points equally.
+ */
+size_t RateTable::EndTable(const ReactionInfo *info) {
+	bool uncertain = t9_.size() > offsets_.back();
+	for (size_t i = offsets_.back(); i < t9_.size() && uncertain; i++) {
+		uncertain = factor_[i] > 1;
+	}
+	offsets_.push_back(t9_.size());
+	hasUncertainty_.push_back(uncertain);
+	if (info) reactions_.push_back(*info);
+	else {
+		ReactionInfo empty;
+		memset(&empty, 0, sizeof(empty));
+		reactions_.push_back(empty);
+	}
+	return GetNumTables() - 1;
+}
+
+void RateTable::DiscardPoints() {
+	t9_.resize(offsets_.back());
+	rate_.resize(offsets_.back());
+	factor_.resize(offsets_.back());
+	sigma_.resize(offsets_.back());
+}
+
+size_t RateTable::AddTable(const double *t9, const double *rate,
+	const double *factor, const size_t n, const ReactionInfo *info
+) {
+	for (size_t i = 0; i < n; i++) AddPoint(t9[i], rate[i], factor ? factor[i] : 0);
+	return EndTable(info);
+}
+
+void RateTable::Clear() {
+	t9_.clear();
+	rate_.clear();
+	factor_.clear();
+	sigma_.clear();
+	offsets_.assign(1, 0);
+	hasUncertainty_.clear();
+	reactions_.clear();
+}
@@ -0,0 +1,116 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef RATETABLE_H
+#define RATETABLE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "RateLibrary.hpp"
+
+/**@brief Tabulated reaction rates stored in contiguous arrays.
+ * @author Karl Smith
+ *
+ * The temperatures, rates and uncertainties of all tables are kept in three
+ * shared arrays with an offset per table, so thousands of tables are held
+ * in a few allocations and each table can be passed to ReaclibFitter or
+ * ReaclibBatchFitter as plain pointers:
+ * @code
+ * 	RateTable tables;
+ * 	RateTableReader reader;
+ * 	reader.LoadStarlib("starlib.dat", tables);
+ * 	for (size_t i = 0; i < tables.GetNumTables(); i++) {
+ * 		job.SetData(tables.GetT9(i), tables.GetRate(i), tables.GetSigma(i),
+ * 			tables.GetNumPoints(i));
+ * 	}
+ * @endcode
+ *
+ * Uncertainties are given as the factor uncertainty f.u. of a lognormal
+ * distribution, as in STARLIB. The corresponding uncertainty of the rate used
+ * by the log space fit is @f$ \sigma = r \ln(f.u.) @f$.
+ */
+class RateTable {
+	public:
+		/// @brief Default constructor.
+		RateTable();
+
+		/// @brief Appends a point to the table being built.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[in] rate The rate.
+		/// @param[in] factor The factor uncertainty of the rate, or zero if
+		///   unknown.
+		void AddPoint(const double t9, const double rate, const double factor = 0);
+
+		/// @brief Completes the table made of the points added since the last
+		///   table.
+		/// @param[in] info The reaction the table describes. If null the
+		///   reaction information is zeroed.
+		/// @return The index of the table.
+		size_t EndTable(const ReactionInfo *info = 0);
+
+		/// @brief Removes the points added since the last completed table.
+		void DiscardPoints();
+
+		/// @brief Adds a complete table.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n rates.
+		/// @param[in] factor Array of n factor uncertainties, may be null.
+		/// @param[in] n The number of points.
+		/// @param[in] info The reaction the table describes, may be null.
+		/// @return The index of the table.
+		size_t AddTable(const double *t9, const double *rate, const double *factor,
+			const size_t n, const ReactionInfo *info = 0);
+
+		/// @brief Removes all tables.
+		void Clear();
+
+		/// @brief Returns the number of completed tables.
+		size_t GetNumTables() const {return offsets_.size() - 1;}
+
+		/// @brief Returns the total number of points in all tables.
+		size_t GetTotalPoints() const {return offsets_.back();}
+
+		/// @brief Returns the number of points in a table.
+		size_t GetNumPoints(const size_t tableId) const {
+			return offsets_[tableId + 1] - offsets_[tableId];
+		}
+
+		/// @brief Returns the temperatures of a table in GK.
+		const double* GetT9(const size_t tableId) const {
+			return t9_.data() + offsets_[tableId];
+		}
+
+		/// @brief Returns the rates of a table.
+		const double* GetRate(const size_t tableId) const {
+			return rate_.data() + offsets_[tableId];
+		}
+
+		/// @brief Returns the factor uncertainties of a table, or null if the
+		///   table has no uncertainties.
+		const double* GetUncertaintyFactor(const size_t tableId) const {
+			return hasUncertainty_[tableId] ? factor_.data() + offsets_[tableId] : 0;
+		}
+
+		/// @brief Returns the uncertainties of the rates of a table, or null if
+		///   the table has no uncertainties.
+		const double* GetSigma(const size_t tableId) const {
+			return hasUncertainty_[tableId] ? sigma_.data() + offsets_[tableId] : 0;
+		}
+
+		/// @brief Returns the reaction a table describes.
+		const ReactionInfo& GetReactionInfo(const size_t tableId) const {
+			return reactions_[tableId];
+		}
+
+	private:
+		std::vector<double> t9_; ///< The temperatures of all points.
+		std::vector<double> rate_; ///< The rates of all points.
+		std::vector<double> factor_; ///< The factor uncertainties of all points.
+		std::vector<double> sigma_; ///< The uncertainties of the rates of all points.
+		std::vector<size_t> offsets_; ///< The first point of each table, followed by the total.
+		std::vector<char> hasUncertainty_; ///< Whether every point of a table has an uncertainty.
+		std::vector<ReactionInfo> reactions_; ///< The reaction of each table.
+};
+
+#endif //RATETABLE_H
@@ -0,0 +1,172 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "RateTableReader.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "ReaclibParser.hpp"
+
+RateTableReader::RateTableReader() :
+	t9Column_(0),
+	rateColumn_(1),
+	factorColumn_(2),
+	skipNonPositive_(true),
+	lineNumber_(0)
+{
+
+}
+
+void RateTableReader::SetColumns(const unsigned int t9Column,
+	const unsigned int rateColumn, const int factorColumn
+) {
+	t9Column_ = t9Column;
+	rateColumn_ = rateColumn;
+	factorColumn_ = factorColumn;
+}
+
+/**The file is read with one call and every line ending is replaced by a null,
+ * so that the lines can be parsed in place. The carriage return of a DOS line
+ * ending becomes a space. A null is appended in case the last line has no 
+ * line ending.
+ */
+bool RateTableReader::ReadFile(const char *filename) {
+	lineNumber_ = 0;
+	FILE *file = fopen(filename, "rb");
+	if (!file) return false;
+	bool success = fseek(file, 0, SEEK_END) == 0;
+	const long size = success ? ftell(file) : -1;
+	success = size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+	if (success) {
+		buffer_.resize(size + 1);
+		success = fread(buffer_.data(), 1, size, file) == static_cast<size_t>(size);
+	}
+	fclose(file);
+	if (!success) return false;
+
+	buffer_[size] = '\0';
+	for (long i = 0; i < size; i++) {
+		if (buffer_[i] == '\r' && i + 1 < size && buffer_[i + 1] == '\n') buffer_[i] = ' ';
+		else if (buffer_[i] == '\n' || buffer_[i] == '\r') buffer_[i] = '\0';
+	}
+	return true;
+}
+
+unsigned int RateTableReader::ParseNumbers(const char *line, double *values,
+	const unsigned int count
+) {
+	unsigned int parsed = 0;
+	while (parsed < count) {
+		while (*line == ' ' || *line == '\t' || *line == ',') line++;
+		const char *end = line;
+		while (*end && *end != ' ' && *end != '\t' && *end != ',') end++;
+		if (end == line) break;
+		if (!ReaclibParser::ParseFixedFloat(line, end - line, values[parsed])) break;
+		parsed++;
+		line = end;
+	}
+	return parsed;
+}
+
+void RateTableReader::AddPoint(RateTable &table, const double t9,
+	const double rate, const double factor
+) const {
+	if (skipNonPositive_ && !(rate > 0)) return;
+	table.AddPoint(t9, rate, factor);
+}
+
+/**A line starting with numbers is a row and must hold at least the T9 and
+ * rate columns. The factor uncertainty is optional. Any other line ends the
+ * current table.
+ */
+int RateTableReader::LoadColumns(const char *filename, RateTable &table,
+	const ReactionInfo *info
+) {
+	if (!ReadFile(filename)) return -1;
+	unsigned int required = (t9Column_ > rateColumn_ ? t9Column_ : rateColumn_) + 1;
+	unsigned int numColumns = required;
+	if (factorColumn_ >= 0 && static_cast<unsigned int>(factorColumn_) >= numColumns) {
+		numColumns = factorColumn_ + 1;
+	}
+	std::vector<double> values(numColumns);
+
+	int numTables = 0;
+	bool inTable = false;
+	const char *end = buffer_.data() + buffer_.size() - 1;
+	for (const char *line = buffer_.data(); line <= end; line += strlen(line) + 1) {
+		lineNumber_++;
+		const unsigned int parsed = ParseNumbers(line, values.data(), numColumns);
+		if (parsed == 0) {
+			if (inTable) {
+				table.EndTable(info);
+				numTables++;
+				inTable = false;
+			}
+			continue;
+		}
+		if (parsed < required) return Fail(table);
+		const bool hasFactor = factorColumn_ >= 0
+			&& parsed > static_cast<unsigned int>(factorColumn_);
+		AddPoint(table, values[t9Column_], values[rateColumn_],
+			hasFactor ? values[factorColumn_] : 0);
+		inTable = true;
+	}
+	if (inTable) {
+		table.EndTable(info);
+		numTables++;
+	}
+	return numTables;
+}
+
+/**Each rate starts with a chapter line followed by the set label line in the
+ * REACLIB layout, which provides the reaction information of the table.
+ * Every following line up to the next chapter line must hold T9, the rate and
+ * the factor uncertainty.
+ */
+int RateTableReader::LoadStarlib(const char *filename, RateTable &table) {
+	if (!ReadFile(filename)) return -1;
+
+	int numTables = 0;
+	bool inRate = false;
+	ReactionInfo info;
+	const char *end = buffer_.data() + buffer_.size() - 1;
+	for (const char *line = buffer_.data(); line <= end; line += strlen(line) + 1) {
+		lineNumber_++;
+		const size_t length = strlen(line);
+		if (strspn(line, " \t") == length) continue;
+
+		const unsigned int chapter = ReaclibParser::ParseChapter(line);
+		if (chapter) {
+			if (inRate) {
+				table.EndTable(&info);
+				numTables++;
+			}
+			line += length + 1;
+			lineNumber_++;
+			if (line > end) return Fail(table);
+
+			//The label columns are read from a copy padded with spaces.
+			char label[256];
+			const size_t labelLength = strlen(line) < 255 ? strlen(line) : 255;
+			memcpy(label, line, labelLength);
+			size_t padded = labelLength;
+			while (padded < ReaclibParser::kLineWidth) label[padded++] = ' ';
+			label[padded] = '\0';
+			if (!ReaclibParser::ParseSetLabel(label, chapter, info)) return Fail(table);
+			inRate = true;
+			continue;
+		}
+		if (!inRate) return Fail(table);
+
+		double values[3];
+		if (ParseNumbers(line, values, 3) < 3) return Fail(table);
+		AddPoint(table, values[0], values[1], values[2]);
+	}
+	if (inRate) {
+		table.EndTable(&info);
+		numTables++;
+	}
+	return numTables;
+}
@@ -0,0 +1,103 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef RATETABLEREADER_H
+#define RATETABLEREADER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "RateLibrary.hpp"
+#include "RateTable.hpp"
+
+/**@brief Reads tabulated reaction rates into a RateTable.
+ * @author Karl Smith
+ *
+ * Two layouts are read:
+ * - Column files, such as NACRE style tables, with whitespace separated
+ *   columns of T9, the rate and optionally the factor uncertainty. Lines
+ *   that do not start with numbers, e.g. headers and lines beginning with
+ *   '#' or '!', and blank lines separate tables.
+ * - STARLIB files, where each rate is a chapter line, a REACLIB set label
+ *   line and rows of T9, the rate and the factor uncertainty.
+ *
+ * The whole file is read into memory with a single read and the numbers are
+ * converted in place with ReaclibParser::ParseFixedFloat, so Fortran style
+ * exponents such as "1.0D-05" are accepted. The points are appended to the
+ * contiguous arrays of the table without building an intermediate graph.
+ *
+ * Points with a rate that is not positive can not be fit in log space and
+ * are skipped by default, see RateTableReader::SetSkipNonPositive.
+ */
+class RateTableReader {
+	public:
+		/// @brief Default constructor.
+		RateTableReader();
+
+		/// @brief Selects the columns of column files, counted from zero.
+		/// @param[in] t9Column The column of the temperature in GK.
+		/// @param[in] rateColumn The column of the rate.
+		/// @param[in] factorColumn The column of the factor uncertainty, or -1
+		///   if there is none.
+		void SetColumns(const unsigned int t9Column, const unsigned int rateColumn,
+			const int factorColumn = 2);
+
+		/// @brief Sets whether points whose rate is not positive are skipped,
+		///   true by default.
+		void SetSkipNonPositive(const bool skip) {skipNonPositive_ = skip;}
+
+		/// @brief Reads the tables of a column file.
+		/// @param[in] filename The path of the file.
+		/// @param[out] table The tables are appended to this table.
+		/// @param[in] info The reaction assigned to every table, may be null.
+		/// @return The number of tables read, or -1 if the file could not be
+		///   read or a line was malformed. On failure the tables completed 
+		///   before the malformed line are kept and the partial table is 
+		///   discarded.
+		int LoadColumns(const char *filename, RateTable &table,
+			const ReactionInfo *info = 0);
+
+		/// @brief Reads the rates of a STARLIB file.
+		/// @param[in] filename The path of the file.
+		/// @param[out] table The tables are appended to this table.
+		/// @return The number of tables read, or -1 if the file could not be
+		///   read or a line was malformed. On failure the tables completed 
+		///   before the malformed line are kept and the partial table is 
+		///   discarded.
+		int LoadStarlib(const char *filename, RateTable &table);
+
+		/// @brief Returns the last line read, i.e. the malformed line if
+		///   reading failed. Zero if the file could not be opened.
+		size_t GetLineNumber() const {return lineNumber_;}
+
+	private:
+		/// @brief Reads a file into the buffer with a null after every line.
+		bool ReadFile(const char *filename);
+
+		/// @brief Parses the leading whitespace separated numbers of a line.
+		/// @param[in] line The null terminated line.
+		/// @param[out] values The parsed numbers.
+		/// @param[in] count The number of numbers to parse.
+		/// @return The number of leading numbers parsed, at most count.
+		static unsigned int ParseNumbers(const char *line, double *values,
+			const unsigned int count);
+
+		/// @brief Discards the partial table and returns -1.
+		static int Fail(RateTable &table) {
+			table.DiscardPoints();
+			return -1;
+		}
+
+		/// @brief Adds a point unless its rate is skipped.
+		void AddPoint(RateTable &table, const double t9, const double rate,
+			const double factor) const;
+
+		unsigned int t9Column_; ///< The temperature column of column files.
+		unsigned int rateColumn_; ///< The rate column of column files.
+		int factorColumn_; ///< The factor uncertainty column, -1 if none.
+		bool skipNonPositive_; ///< Whether points with a rate <= 0 are skipped.
+		size_t lineNumber_; ///< The number of lines read.
+		std::vector<char> buffer_; ///< The contents of the file.
+};
+
+#endif //RATETABLEREADER_H
@@ -0,0 +1,130 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibBatchFitter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ParallelFor.hpp"
+
+ReaclibBatchFitter::Job::Job(const unsigned int z1, const unsigned int z2,
+	const float mu, const unsigned int numResonances
+) :
+	z1(z1),
+	z2(z2),
+	mu(mu),
+	numResonances(numResonances),
+	sFactor(0),
+	t9(0),
+	rate(0),
+	sigma(0),
+	n(0)
+{
+	memset(&info, 0, sizeof(info));
+}
+
+void ReaclibBatchFitter::Job::SetData(const double *t9, const double *rate,
+	const double *sigma, const size_t n
+) {
+	this->t9 = t9;
+	this->rate = rate;
+	this->sigma = sigma;
+	this->n = n;
+}
+
+void ReaclibBatchFitter::Job::SetSFactor(const float s0_MeVb) {
+	sFactor = s0_MeVb;
+}
+
+void ReaclibBatchFitter::Job::AddResonance(const float energy,
+	const float strength, const bool free
+) {
+	energies.push_back(energy);
+	strengths.push_back(strength);
+	freeResonances.push_back(free);
+}
+
+ReaclibBatchFitter::ReaclibBatchFitter() :
+	numThreads_(0),
+	numStarts_(1)
+{
+
+}
+
+/**The model is built as by ReaclibRate: S(0) and the resonances fix their
+ * parameters unless the resonance is marked as free, in which case its
+ * energy and strength are only the starting point.
+ */
+size_t ReaclibBatchFitter::AddJob(const Job &job) {
+	ReaclibModel model(job.numResonances, job.z1, job.z2, job.mu);
+	if (job.sFactor > 0) model.SetSFactor(job.sFactor);
+	for (unsigned int i = 0; i < job.energies.size() && i < job.numResonances; i++) {
+		model.SetResonance(i, job.energies[i], job.strengths[i]);
+		if (job.freeResonances[i]) {
+			model.ReleaseParameter(7 * (i + 1) + 0);
+			model.ReleaseParameter(7 * (i + 1) + 1);
+		}
+	}
+
+	jobs_.push_back(job);
+	models_.push_back(model);
+	results_.push_back(ReaclibFitter::Result());
+	errors_.push_back(std::vector<double>());
+	success_.push_back(false);
+	return jobs_.size() - 1;
+}
+
+void ReaclibBatchFitter::Clear() {
+	jobs_.clear();
+	models_.clear();
+	results_.clear();
+	errors_.clear();
+	success_.clear();
+}
+
+/**Each job writes only its own model and results, and each thread owns a
+ * fitter whose buffers are reused by the jobs it runs.
+ */
+size_t ReaclibBatchFitter::Run() {
+	const unsigned int threads = ParallelThreads(numThreads_, jobs_.size());
+	std::vector<ReaclibFitter> fitters(threads, multiStart_.GetFitter());
+	std::vector<ReaclibMultiStart> multiStarts(numStarts_ > 1 ? threads : 0, 
+		multiStart_);
+	for (size_t t = 0; t < multiStarts.size(); t++) {
+		multiStarts[t].SetNumStarts(numStarts_);
+		multiStarts[t].SetNumThreads(1);
+	}
+
+	ParallelFor(jobs_.size(), threads, [&](const size_t jobId, const unsigned int thread) {
+		const Job &job = jobs_[jobId];
+		if (numStarts_ > 1) {
+			ReaclibMultiStart &multiStart = multiStarts[thread];
+			success_[jobId] = multiStart.Fit(models_[jobId], job.t9, job.rate, 
+				job.sigma, job.n, &results_[jobId]);
+			errors_[jobId] = multiStart.GetErrors();
+		}
+		else {
+			ReaclibFitter &fitter = fitters[thread];
+			success_[jobId] = fitter.Fit(models_[jobId], job.t9, job.rate, 
+				job.sigma, job.n, &results_[jobId]);
+			errors_[jobId] = fitter.GetErrors();
+		}
+	});
+	return std::count(success_.begin(), success_.end(), true);
+}
+
+size_t ReaclibBatchFitter::AddToLibrary(RateLibrary &library) const {
+	size_t numAdded = 0;
+	for (size_t i = 0; i < jobs_.size(); i++) {
+		if (!success_[i]) continue;
+		const Job &job = jobs_[i];
+		const double t9Min = *std::min_element(job.t9, job.t9 + job.n);
+		const double t9Max = *std::max_element(job.t9, job.t9 + job.n);
+		library.AddRate(models_[i].GetParameters(), models_[i].GetNumSets(),
+			models_[i].GetSetTypes(), t9Min, t9Max, &job.info);
+		numAdded++;
+	}
+	return numAdded;
+}
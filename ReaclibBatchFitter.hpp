@@ -0,0 +1,152 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBBATCHFITTER_H
+#define REACLIBBATCHFITTER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "RateLibrary.hpp"
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibMultiStart.hpp"
+
+/**@brief Fits many rates concurrently.
+ * @author Karl Smith
+ *
+ * Each job describes a rate by the charges and reduced mass of the reactants,
+ * the number of resonances with their initial energies and strengths, and the
+ * tabulated data to fit. The model of a job is built as by ReaclibRate when
+ * the job is added. ReaclibBatchFitter::Run then fits all jobs over a pool of
+ * threads, each with its own fitter, so no state is shared between fits:
+ * @code
+ * 	ReaclibBatchFitter batch;
+ * 	for (size_t i = 0; i < tables.size(); i++) {
+ * 		ReaclibBatchFitter::Job job(6, 1, 0.923, 1);
+ * 		job.SetData(tables[i].t9, tables[i].rate, tables[i].sigma, tables[i].n);
+ * 		job.AddResonance(0.422, 8.6e-3, true);
+ * 		batch.AddJob(job);
+ * 	}
+ * 	batch.Run();
+ * 	batch.AddToLibrary(library);
+ * @endcode
+ * The data arrays are not copied and must remain valid until the fits have
+ * run. Rates with several free resonances can be fit from many starts with 
+ * ReaclibBatchFitter::SetNumStarts, in which case the starts of a job run on 
+ * the thread of the job (See ReaclibMultiStart).
+ */
+class ReaclibBatchFitter {
+	public:
+		/// @brief A rate to be fit.
+		struct Job {
+			/// @brief Constructor.
+			/// @param[in] z1 The atomic number of the target.
+			/// @param[in] z2 The atomic number of the reactant.
+			/// @param[in] mu The reduced mass of the reactants in amu.
+			/// @param[in] numResonances The number of resonance sets.
+			Job(const unsigned int z1, const unsigned int z2, const float mu,
+				const unsigned int numResonances);
+
+			/// @brief Sets the data to fit.
+			/// @param[in] t9 Array of n temperatures in GK.
+			/// @param[in] rate Array of n positive rates.
+			/// @param[in] sigma Array of n uncertainties, may be null.
+			/// @param[in] n The number of points.
+			void SetData(const double *t9, const double *rate, const double *sigma,
+				const size_t n);
+
+			/// @brief Sets S(0), fixing the a0 term of the non-resonant set.
+			/// @param[in] s0_MeVb The S-factor at zero energy in MeV-b.
+			void SetSFactor(const float s0_MeVb);
+
+			/// @brief Sets the next resonance.
+			/// @param[in] energy The resonance energy in MeV.
+			/// @param[in] strength The resonance strength.
+			/// @param[in] free If true the energy and strength are fit, otherwise
+			///   they are fixed.
+			void AddResonance(const float energy, const float strength,
+				const bool free = false);
+
+			unsigned int z1; ///< The atomic number of the target.
+			unsigned int z2; ///< The atomic number of the reactant.
+			float mu; ///< The reduced mass of the reactants in amu.
+			unsigned int numResonances; ///< The number of resonance sets.
+			float sFactor; ///< S(0) in MeV-b, or zero if a0 is fit.
+			std::vector<float> energies; ///< The initial resonance energies in MeV.
+			std::vector<float> strengths; ///< The initial resonance strengths.
+			std::vector<char> freeResonances; ///< Whether each resonance is fit.
+			const double *t9; ///< The temperatures of the data in GK.
+			const double *rate; ///< The tabulated rate.
+			const double *sigma; ///< The uncertainties of the rate, may be null.
+			size_t n; ///< The number of points.
+			ReactionInfo info; ///< The reaction, used when adding to a library.
+		};
+
+		/// @brief Default constructor.
+		ReaclibBatchFitter();
+
+		/// @brief Sets the number of threads, 0 by default for the number of
+		///   hardware threads.
+		void SetNumThreads(const unsigned int numThreads) {numThreads_ = numThreads;}
+
+		/// @brief Returns the fitter settings applied to every job.
+		ReaclibFitter& GetFitter() {return multiStart_.GetFitter();}
+
+		/// @brief Returns the multi-start settings applied to every job. The
+		///   number of threads is ignored.
+		ReaclibMultiStart& GetMultiStart() {return multiStart_;}
+
+		/// @brief Sets the number of starts of each job, 1 by default for a 
+		///   single fit from the initial model.
+		void SetNumStarts(const unsigned int numStarts) {numStarts_ = numStarts;}
+
+		/// @brief Adds a job and builds its initial model.
+		/// @param[in] job The job.
+		/// @return The index of the job.
+		size_t AddJob(const Job &job);
+
+		/// @brief Removes all jobs.
+		void Clear();
+
+		/// @brief Returns the number of jobs.
+		size_t GetNumJobs() const {return jobs_.size();}
+
+		/// @brief Fits every job.
+		/// @return The number of jobs that were fit successfully.
+		size_t Run();
+
+		/// @brief Returns true if the job was fit.
+		bool GetSuccess(const size_t jobId) const {return success_[jobId];}
+
+		/// @brief Returns the model of a job, fitted once Run has returned.
+		const ReaclibModel& GetModel(const size_t jobId) const {return models_[jobId];}
+
+		/// @brief Returns the outcome of the fit of a job.
+		const ReaclibFitter::Result& GetResult(const size_t jobId) const {
+			return results_[jobId];
+		}
+
+		/// @brief Returns the parameter errors of a job.
+		const std::vector<double>& GetErrors(const size_t jobId) const {
+			return errors_[jobId];
+		}
+
+		/// @brief Adds every successfully fit rate to a library. The validity
+		///   range of a rate is the temperature range of its data.
+		/// @param[in] library The library receiving the rates.
+		/// @return The number of rates added.
+		size_t AddToLibrary(RateLibrary &library) const;
+
+	private:
+		unsigned int numThreads_; ///< The number of threads, 0 for all.
+		unsigned int numStarts_; ///< The number of starts of each job.
+		ReaclibMultiStart multiStart_; ///< Holds the fitter and multi-start settings.
+		std::vector<Job> jobs_; ///< The jobs.
+		std::vector<ReaclibModel> models_; ///< The model of each job.
+		std::vector<ReaclibFitter::Result> results_; ///< The outcome of each fit.
+		std::vector<std::vector<double> > errors_; ///< The parameter errors of each fit.
+		std::vector<char> success_; ///< Whether each job was fit.
+};
+
+#endif //REACLIBBATCHFITTER_H
@@ -0,0 +1,229 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibFitter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	///The damping factor the fit starts with.
+	const double kInitialLambda = 1e-3;
+	///The damping factor above which no step can reduce chi-square.
+	const double kMaxLambda = 1e16;
+}
+
+ReaclibFitter::ReaclibFitter() :
+	maxIterations_(200),
+	tolerance_(1e-10),
+	numSets_(0)
+{
+
+}
+
+/**The evaluation of a set skips the terms its structural type assumes fixed
+ * (See ReaclibKernel::SetType). If such a term is free in the model the set
+ * is fit as ReaclibKernel::kGeneral, otherwise the term would have no effect
+ * on the rate while its derivative does not vanish.
+ *
+ * Each iteration solves the damped normal equations
+ * @f[
+ * 	(\alpha + \lambda\, diag(\alpha))\, \delta = \beta
+ * @f]
+ * for a step @f$ \delta @f$. A step reducing chi-square is taken and the
+ * damping reduced, otherwise the damping is increased. The fit has converged
+ * when chi-square or the parameters change by less than the tolerance, or
+ * when no step reduces chi-square.
+ *
+ * After the fit the errors are the square roots of the diagonal of the
+ * inverse of @f$ \alpha @f$. Without uncertainties they are scaled by
+ * @f$ \chi^2 / ndf @f$ as the relative uncertainty of the points is unknown.
+ */
+bool ReaclibFitter::Fit(ReaclibModel &model, const double *t9,
+	const double *rate, const double *sigma, const size_t n, Result *result
+) {
+	const unsigned int numPar = model.GetNumParameters();
+	numSets_ = model.GetNumSets();
+
+	free_.clear();
+	for (unsigned int i = 0; i < numPar; i++) {
+		if (!model.IsFixed(i)) free_.push_back(i);
+	}
+	const size_t numFree = free_.size();
+	errors_.assign(numPar, 0);
+	if (n <= numFree) return false;
+
+	setTypes_.assign(model.GetSetTypes(), model.GetSetTypes() + numSets_);
+	for (unsigned int i = 0; i < numFree; i++) {
+		const unsigned int set = free_[i] / 7, term = free_[i] % 7;
+		if ((setTypes_[set] == ReaclibKernel::kNonResonant && term == 1) ||
+			(setTypes_[set] == ReaclibKernel::kNarrowResonance && term >= 2)) {
+			setTypes_[set] = ReaclibKernel::kGeneral;
+		}
+	}
+
+	bases_.clear();
+	logRate_.resize(n);
+	weight_.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		if (!(rate[i] > 0) || (sigma && !(sigma[i] > 0))) return false;
+		bases_.push_back(TemperatureBasis(t9[i]));
+		logRate_[i] = log(rate[i]);
+		weight_[i] = sigma ? rate[i] / sigma[i] : 1;
+	}
+
+	grad_.resize(numPar);
+	alpha_.resize(numFree * numFree);
+	beta_.resize(numFree);
+	factor_.resize(numFree * numFree);
+	step_.resize(numFree);
+	par_.assign(model.GetParameters(), model.GetParameters() + numPar);
+	trial_ = par_;
+
+	double lambda = kInitialLambda;
+	double chi2 = ComputeNormalEquations(par_.data());
+	//The number of passes over the data.
+	size_t numPasses = 1;
+	bool converged = numFree == 0 || chi2 == 0;
+	unsigned int iteration = 0;
+	while (!converged && iteration < maxIterations_) {
+		iteration++;
+		if (!SolveStep(lambda)) {
+			lambda *= 10;
+			converged = lambda > kMaxLambda;
+			continue;
+		}
+
+		double maxChange = 0;
+		for (size_t j = 0; j < numFree; j++) {
+			const unsigned int k = free_[j];
+			trial_[k] = par_[k] + step_[j];
+			const double change = fabs(step_[j]) / (fabs(par_[k]) + tolerance_);
+			if (change > maxChange) maxChange = change;
+		}
+
+		const double trialChi2 = ComputeChi2(trial_.data());
+		numPasses++;
+		if (std::isfinite(trialChi2) && trialChi2 <= chi2) {
+			converged = chi2 - trialChi2 <= tolerance_ * chi2
+				|| maxChange <= tolerance_;
+			par_.swap(trial_);
+			if (lambda > 1e-12) lambda /= 10;
+			chi2 = ComputeNormalEquations(par_.data());
+			numPasses++;
+			trial_ = par_;
+		}
+		else {
+			for (size_t j = 0; j < numFree; j++) trial_[free_[j]] = par_[free_[j]];
+			lambda *= 10;
+			converged = lambda > kMaxLambda;
+		}
+	}
+
+	//Sets promoted to general for a free skipped term keep the promotion, so
+	//the model evaluates the function that was fit.
+	model.SetSets(par_.data(), setTypes_.data());
+	const unsigned int ndf = n - numFree;
+	ComputeErrors(sigma ? 1 : chi2 / ndf);
+
+	if (result) {
+		result->converged = converged;
+		result->iterations = iteration;
+		result->functionCalls = numPasses * n;
+		result->chi2 = chi2;
+		result->ndf = ndf;
+	}
+	return true;
+}
+
+double ReaclibFitter::ComputeChi2(const double *par) const {
+	double chi2 = 0;
+	for (size_t i = 0; i < bases_.size(); i++) {
+		const double residual = weight_[i] * (ReaclibKernel::EvaluateLog(
+			bases_[i], par, setTypes_.data(), numSets_) - logRate_[i]);
+		chi2 += residual * residual;
+	}
+	return chi2;
+}
+
+/**Fills the upper triangle of the symmetric normal matrix and mirrors it.
+ */
+double ReaclibFitter::ComputeNormalEquations(const double *par) {
+	const size_t numFree = free_.size();
+	std::fill(alpha_.begin(), alpha_.end(), 0);
+	std::fill(beta_.begin(), beta_.end(), 0);
+	double chi2 = 0;
+	for (size_t i = 0; i < bases_.size(); i++) {
+		const double logModel = ReaclibKernel::EvaluateGradient(bases_[i], par,
+			setTypes_.data(), numSets_, grad_.data(), true);
+		const double w2 = weight_[i] * weight_[i];
+		const double residual = logModel - logRate_[i];
+		chi2 += w2 * residual * residual;
+		for (size_t j = 0; j < numFree; j++) {
+			const double gj = w2 * grad_[free_[j]];
+			beta_[j] -= gj * residual;
+			for (size_t k = j; k < numFree; k++) {
+				alpha_[j * numFree + k] += gj * grad_[free_[k]];
+			}
+		}
+	}
+	for (size_t j = 0; j < numFree; j++) {
+		for (size_t k = 0; k < j; k++) {
+			alpha_[j * numFree + k] = alpha_[k * numFree + j];
+		}
+	}
+	return chi2;
+}
+
+/**The damped matrix is decomposed as @f$ L L^T @f$ and the step found by
+ * forward and back substitution. Parameters that do not affect any point
+ * have a zero diagonal, which is damped with unit scale instead.
+ */
+bool ReaclibFitter::SolveStep(const double lambda) {
+	const size_t m = free_.size();
+	for (size_t j = 0; j < m; j++) {
+		for (size_t k = 0; k <= j; k++) {
+			double sum = alpha_[j * m + k];
+			if (j == k) sum += lambda * (sum > 0 ? sum : 1);
+			for (size_t l = 0; l < k; l++) sum -= factor_[j * m + l] * factor_[k * m + l];
+			if (j == k) {
+				if (!(sum > 0)) return false;
+				factor_[j * m + j] = sqrt(sum);
+			}
+			else factor_[j * m + k] = sum / factor_[k * m + k];
+		}
+	}
+	for (size_t j = 0; j < m; j++) {
+		double sum = beta_[j];
+		for (size_t l = 0; l < j; l++) sum -= factor_[j * m + l] * step_[l];
+		step_[j] = sum / factor_[j * m + j];
+	}
+	for (size_t j = m; j-- > 0; ) {
+		double sum = step_[j];
+		for (size_t l = j + 1; l < m; l++) sum -= factor_[l * m + j] * step_[l];
+		step_[j] = sum / factor_[j * m + j];
+	}
+	return true;
+}
+
+/**The columns of the inverse are found by solving against unit vectors with
+ * the undamped decomposition. If the normal matrix is singular the errors are
+ * left at zero.
+ */
+void ReaclibFitter::ComputeErrors(const double scale) {
+	const size_t m = free_.size();
+	std::fill(errors_.begin(), errors_.end(), 0);
+	if (!m || !SolveStep(0)) return;
+	for (size_t c = 0; c < m; c++) {
+		//Solve L y = e_c, the variance is then the squared norm of y.
+		for (size_t j = c; j < m; j++) {
+			double sum = j == c ? 1 : 0;
+			for (size_t l = c; l < j; l++) sum -= factor_[j * m + l] * step_[l];
+			step_[j] = sum / factor_[j * m + j];
+		}
+		double variance = 0;
+		for (size_t j = c; j < m; j++) variance += step_[j] * step_[j];
+		errors_[free_[c]] = sqrt(variance * scale);
+	}
+}
@@ -0,0 +1,125 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBFITTER_H
+#define REACLIBFITTER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "ReaclibKernel.hpp"
+#include "ReaclibModel.hpp"
+#include "TemperatureBasis.hpp"
+
+/// @brief The outcome of a fit with ReaclibFitter, declared outside the class
+///   so it can be forward declared.
+struct ReaclibFitResult {
+	bool converged; ///< True if the fit converged within the iteration limit.
+	unsigned int iterations; ///< The number of iterations performed.
+	/// The number of evaluations of the model, one per point for each pass over the data.
+	size_t functionCalls;
+	double chi2; ///< The chi-square of the final parameters.
+	unsigned int ndf; ///< The number of points less the number of free parameters.
+};
+
+/**@brief A Levenberg-Marquardt fitter for the free parameters of a
+ *   ReaclibModel.
+ * @author Karl Smith
+ *
+ * Tabulated rates are fit in log space, minimizing
+ * @f[
+ * 	\chi^2 = \sum_i \left(\frac{\ln\lambda(T_{9,i}) - \ln r_i}{\sigma_i / r_i}
+ * 		\right)^2
+ * @f]
+ * with the analytic Jacobian of ReaclibKernel::EvaluateGradient. Only the
+ * parameters that are free in the model are varied, so the layout set up by
+ * the constructor, ReaclibModel::SetSFactor and ReaclibModel::SetResonance
+ * is respected. The normal equations are small and dense and are solved by a
+ * Cholesky decomposition.
+ *
+ * The temperature terms, Jacobian and normal equations are kept between
+ * fits, so a fitter reused for many rates does not allocate once it has
+ * grown to the largest problem. A fitter must not be shared between threads.
+ * @code
+ * 	ReaclibFitter fitter;
+ * 	ReaclibFitter::Result result;
+ * 	if (fitter.Fit(model, t9, rate, sigma, numPoints, &result)) {
+ * 		printf("chi2 / ndf = %f\n", result.chi2 / result.ndf);
+ * 	}
+ * @endcode
+ */
+class ReaclibFitter {
+	public:
+		/// The outcome of a fit.
+		typedef ReaclibFitResult Result;
+
+		/// @brief Default constructor.
+		ReaclibFitter();
+
+		/// @brief Sets the maximum number of iterations.
+		/// @param[in] maxIterations The iteration limit, 200 by default.
+		void SetMaxIterations(const unsigned int maxIterations) {
+			maxIterations_ = maxIterations;
+		}
+
+		/// @brief Sets the convergence tolerance.
+		/// @param[in] tolerance The relative change in chi-square and in the
+		///   parameters below which the fit has converged, 1e-10 by default.
+		void SetTolerance(const double tolerance) {tolerance_ = tolerance;}
+
+		/// @brief Fits the free parameters of a model to a tabulated rate.
+		/// @param[in,out] model The model, whose parameters are the starting
+		///   point and are replaced by the fitted values.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] sigma Array of n uncertainties of the rates. If null every
+		///   point has the same relative uncertainty.
+		/// @param[in] n The number of points.
+		/// @param[out] result The outcome of the fit, may be null.
+		/// @return False if the data can not be fit, i.e. there are no more 
+		///   points than free parameters or a rate or uncertainty is not positive.
+		bool Fit(ReaclibModel &model, const double *t9, const double *rate,
+			const double *sigma, const size_t n, Result *result = 0);
+
+		/// @brief Returns the uncertainty of each parameter from the last fit,
+		///   zero for fixed parameters.
+		const std::vector<double>& GetErrors() const {return errors_;}
+
+	private:
+		/// @brief Computes the chi-square of the parameters.
+		double ComputeChi2(const double *par) const;
+
+		/// @brief Computes the chi-square, the gradient and the normal matrix of
+		///   the free parameters.
+		double ComputeNormalEquations(const double *par);
+
+		/// @brief Solves the damped normal equations for a step.
+		/// @param[in] lambda The damping factor.
+		/// @return False if the damped matrix is not positive definite.
+		bool SolveStep(const double lambda);
+
+		/// @brief Inverts the normal matrix to obtain the parameter errors.
+		/// @param[in] scale Factor applied to the covariance matrix.
+		void ComputeErrors(const double scale);
+
+		unsigned int maxIterations_; ///< The iteration limit.
+		double tolerance_; ///< The convergence tolerance.
+
+		unsigned int numSets_; ///< The number of sets of the model being fit.
+		std::vector<ReaclibKernel::SetType> setTypes_; ///< The set types used while fitting.
+		std::vector<unsigned int> free_; ///< The indices of the free parameters.
+		std::vector<TemperatureBasis, AlignedAllocator<TemperatureBasis> > bases_; ///< The temperature terms of each point.
+		std::vector<double> logRate_; ///< The logarithm of each rate.
+		std::vector<double> weight_; ///< The inverse log space uncertainty of each point.
+		std::vector<double> grad_; ///< Gradient of a single point.
+		std::vector<double> alpha_; ///< The normal matrix of the free parameters.
+		std::vector<double> beta_; ///< The gradient of chi-square of the free parameters.
+		std::vector<double> factor_; ///< The Cholesky factor of the damped matrix.
+		std::vector<double> step_; ///< The step in the free parameters.
+		std::vector<double> par_; ///< The current parameters.
+		std::vector<double> trial_; ///< The trial parameters.
+		std::vector<double> errors_; ///< The parameter errors of the last fit.
+};
+
+#endif //REACLIBFITTER_H
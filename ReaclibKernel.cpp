@@ -0,0 +1,433 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibKernel.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+	const size_t kLanes = ReaclibKernel::kBlockSize;
+	///Adding this constant to a double of magnitude below 2^51 rounds it to an
+	/// integer stored in the low bits of the mantissa.
+	const double kShift = 6755399441055744.0;
+	const double kLn2Hi = 6.93147180369123816490e-01;
+	const double kLn2Lo = 1.90821492927058770002e-10;
+	const double kInf = std::numeric_limits<double>::infinity();
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+//The vector helpers are internal and always inlined, so the ABI used to pass
+// wide vectors between them does not matter.
+#pragma GCC diagnostic ignored "-Wpsabi"
+#define REACLIB_INLINE inline __attribute__((always_inline))
+
+namespace {
+	///A block of temperatures held in SIMD registers.
+	typedef double VecD __attribute__((vector_size(kLanes * sizeof(double))));
+	///The bit pattern of a VecD.
+	typedef uint64_t VecU __attribute__((vector_size(kLanes * sizeof(double))));
+
+	REACLIB_INLINE VecD Splat(const double x) {
+		return VecD{} + x;
+	}
+
+	REACLIB_INLINE VecD Load(const double *x) {
+		VecD v;
+		memcpy(&v, x, sizeof(v));
+		return v;
+	}
+
+	REACLIB_INLINE void Store(double *x, const VecD &v) {
+		memcpy(x, &v, sizeof(v));
+	}
+
+	/**Returns 2^k for an integer valued k in [-1022, 1023].
+	 */
+	REACLIB_INLINE VecD Pow2(const VecD &k) {
+		const VecU bits = (VecU) (k + kShift) - (VecU) Splat(kShift);
+		return (VecD) ((bits + 1023) << 52);
+	}
+
+	/**Evaluates the polynomial approximating exp(r) for |r| <= ln(2) / 2 at
+	 * the accuracy of the tier (See ReaclibKernel::Accuracy). The full tier
+	 * uses the degree 13 Taylor polynomial, whose truncation error is below
+	 * 1e-17. The other tiers interpolate at the Chebyshev nodes of the 
+	 * interval, which is close to the minimax error.
+	 */
+	template <ReaclibKernel::Accuracy A>
+	REACLIB_INLINE VecD ExpPolynomial(const VecD &r) {
+		VecD p;
+		if (A == ReaclibKernel::kFast) {
+			p = Splat(8.36914849085698357e-03);
+			p = p * r + 4.19175072496152669e-02;
+			p = p * r + 1.66665052604081135e-01;
+			p = p * r + 4.99988693783033980e-01;
+			p = p * r + 1.00000001077157014e+00;
+			return p * r + 1.00000007545489719e+00;
+		}
+		if (A == ReaclibKernel::kHigh) {
+			p = Splat(2.48761640393609060e-05);
+			p = p * r + 1.99158669275258507e-04;
+			p = p * r + 1.38888216775466978e-03;
+			p = p * r + 8.33326609794777210e-03;
+			p = p * r + 4.16666668909580348e-02;
+			p = p * r + 1.66666668910457894e-01;
+			p = p * r + 4.99999999997979307e-01;
+			p = p * r + 9.99999999979785165e-01;
+			return p * r + 1.;
+		}
+		p = Splat(1. / 6227020800.);
+		p = p * r + 1. / 479001600.;
+		p = p * r + 1. / 39916800.;
+		p = p * r + 1. / 3628800.;
+		p = p * r + 1. / 362880.;
+		p = p * r + 1. / 40320.;
+		p = p * r + 1. / 5040.;
+		p = p * r + 1. / 720.;
+		p = p * r + 1. / 120.;
+		p = p * r + 1. / 24.;
+		p = p * r + 1. / 6.;
+		p = p * r + 0.5;
+		p = p * r + 1.;
+		return p * r + 1.;
+	}
+
+	/**Computes exp(x) lane wise. The argument is reduced by multiples of ln 2 
+	 * and the remainder, |r| < 0.35, is evaluated with the polynomial of the
+	 * accuracy tier. The scaling by 2^k is split in two so that overflow to
+	 * infinity and gradual underflow behave as in libm. In the full tier the
+	 * relative error is below 2 ulp for normal results.
+	 */
+	template <ReaclibKernel::Accuracy A>
+	REACLIB_INLINE VecD VecExp(const VecD &arg) {
+		VecD x = arg < -746. ? Splat(-746.) : arg;
+		x = x > 710. ? Splat(710.) : x;
+		const VecD n = (x * 1.4426950408889634 + kShift) - kShift;
+		const VecD r = (x - n * kLn2Hi) - n * kLn2Lo;
+		const VecD p = ExpPolynomial<A>(r);
+		const VecD n1 = (n * 0.5 + kShift) - kShift;
+		return p * Pow2(n1) * Pow2(n - n1);
+	}
+
+	/**Computes ln(x) lane wise with the reduction and minimax polynomial of 
+	 * fdlibm, accurate to below 1 ulp. Non-positive arguments give -inf or NaN.
+	 */
+	REACLIB_INLINE VecD VecLog(const VecD &x) {
+		//Bring subnormal values into the normal range.
+		const auto tiny = x < std::numeric_limits<double>::min();
+		const VecU bits = (VecU) (tiny ? x * 18014398509481984. : x);
+		//Split into exponent and a mantissa in [1, 2).
+		VecD e = (VecD) ((VecU) Splat(kShift) + (bits >> 52)) - (kShift + 1023.);
+		e = tiny ? e - 54. : e;
+		VecD m = (VecD) ((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+		//Move the mantissa to [sqrt(1/2), sqrt(2)).
+		const auto high = m > 1.4142135623730951;
+		m = high ? m * 0.5 : m;
+		e = high ? e + 1. : e;
+
+		const VecD f = m - 1.;
+		const VecD s = f / (2. + f);
+		const VecD z = s * s;
+		const VecD w = z * z;
+		const VecD t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 
+			+ w * 1.531383769920937332e-01));
+		const VecD t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 
+			+ w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+		const VecD hfsq = 0.5 * f * f;
+		const VecD result = e * kLn2Hi 
+			- ((hfsq - (s * (hfsq + t1 + t2) + e * kLn2Lo)) - f);
+
+		VecD special = x == 0 ? Splat(-kInf) 
+			: Splat(std::numeric_limits<double>::quiet_NaN());
+		special = x == kInf ? Splat(kInf) : special;
+		return (x > 0 && x < kInf) ? result : special;
+	}
+
+	/**Computes the cube root lane wise from the logarithm of the argument as 
+	 * exp(ln(x) / 3), followed by one Newton step which brings the result to
+	 * within an ulp or so of the exact value.
+	 */
+	REACLIB_INLINE VecD VecCbrt(const VecD &x, const VecD &lnX) {
+		const VecD c = VecExp<ReaclibKernel::kFull>(lnX * (1. / 3.));
+		const VecD newton = c * (2. / 3.) + x / (3. * c * c);
+		return (c > 0 && c < kInf) ? newton : c;
+	}
+
+	/**Evaluates one full block of temperatures. The temperature terms are 
+	 * computed at full precision and only the exponential of each set uses
+	 * the accuracy tier, so the error the tier adds to the rate stays within
+	 * its bound.
+	 */
+	template <ReaclibKernel::Accuracy A>
+	REACLIB_INLINE void EvaluateBlock(const double *t9Ptr, double *out, 
+		const double *par, const ReaclibKernel::SetType *setTypes, 
+		const unsigned int numSets
+	) {
+		//The temperature terms are shared by all sets.
+		const VecD t9 = Load(t9Ptr);
+		const VecD lnT9 = VecLog(t9);
+		const VecD t9Third = VecCbrt(t9, lnT9);
+		const VecD t9InvThird = 1. / t9Third;
+		const VecD t9Inv = t9InvThird * t9InvThird * t9InvThird;
+		const VecD t9FiveThirds = t9 * t9Third * t9Third;
+
+		VecD reacRate = Splat(0);
+		//Sum of the narrow resonances before applying the T9^-3/2 factor.
+		VecD resonant = Splat(0);
+		bool hasResonance = false;
+		for (unsigned int i = 0; i < numSets; i++) {
+			const double *a = par + 7 * i;
+			switch (setTypes[i]) {
+				case ReaclibKernel::kNarrowResonance:
+					resonant += VecExp<A>(a[0] + a[1] * t9Inv);
+					hasResonance = true;
+					break;
+				case ReaclibKernel::kNonResonant:
+					reacRate += VecExp<A>(a[0] + a[2] * t9InvThird + a[3] * t9Third 
+						+ a[4] * t9 + a[5] * t9FiveThirds + a[6] * lnT9);
+					break;
+				default:
+					reacRate += VecExp<A>(a[0] + a[1] * t9Inv + a[2] * t9InvThird 
+						+ a[3] * t9Third + a[4] * t9 + a[5] * t9FiveThirds 
+						+ a[6] * lnT9);
+			}
+		}
+		//The factor is shared by the resonances and kept at full precision.
+		if (hasResonance) {
+			reacRate += resonant * VecExp<ReaclibKernel::kFull>(-1.5 * lnT9);
+		}
+		Store(out, reacRate);
+	}
+
+	/**Evaluates all temperatures block by block. A trailing partial block is
+	 * padded with T9 = 1 and only the valid values are copied out.
+	 */
+	template <ReaclibKernel::Accuracy A>
+	REACLIB_INLINE void EvaluateBlocks(const double *t9, double *out, 
+		const size_t n, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets
+	) {
+		size_t start = 0;
+		for (; start + kLanes <= n; start += kLanes) {
+			EvaluateBlock<A>(t9 + start, out + start, par, setTypes, numSets);
+		}
+		if (start < n) {
+			double t9Block[kLanes], outBlock[kLanes];
+			for (size_t k = 0; k < kLanes; k++) {
+				t9Block[k] = start + k < n ? t9[start + k] : 1.;
+			}
+			EvaluateBlock<A>(t9Block, outBlock, par, setTypes, numSets);
+			for (size_t k = 0; start + k < n; k++) out[start + k] = outBlock[k];
+		}
+	}
+
+	__attribute__((target("avx512f")))
+	void EvaluateBatchAvx512(const double *t9, double *out, 
+		const size_t n, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets,
+		const ReaclibKernel::Accuracy accuracy
+	) {
+		switch (accuracy) {
+			case ReaclibKernel::kFast:
+				EvaluateBlocks<ReaclibKernel::kFast>(t9, out, n, par, setTypes, numSets);
+				break;
+			case ReaclibKernel::kHigh:
+				EvaluateBlocks<ReaclibKernel::kHigh>(t9, out, n, par, setTypes, numSets);
+				break;
+			default:
+				EvaluateBlocks<ReaclibKernel::kFull>(t9, out, n, par, setTypes, numSets);
+		}
+	}
+
+	__attribute__((target("avx2,fma")))
+	void EvaluateBatchAvx2(const double *t9, double *out, 
+		const size_t n, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets,
+		const ReaclibKernel::Accuracy accuracy
+	) {
+		switch (accuracy) {
+			case ReaclibKernel::kFast:
+				EvaluateBlocks<ReaclibKernel::kFast>(t9, out, n, par, setTypes, numSets);
+				break;
+			case ReaclibKernel::kHigh:
+				EvaluateBlocks<ReaclibKernel::kHigh>(t9, out, n, par, setTypes, numSets);
+				break;
+			default:
+				EvaluateBlocks<ReaclibKernel::kFull>(t9, out, n, par, setTypes, numSets);
+		}
+	}
+
+	/**Computes exp over an array block by block. A trailing partial block is
+	 * padded with zeros and only the valid values are copied out.
+	 */
+	template <ReaclibKernel::Accuracy A>
+	REACLIB_INLINE void ExpBlocks(const double *x, double *y, const size_t n) {
+		size_t start = 0;
+		for (; start + kLanes <= n; start += kLanes) {
+			Store(y + start, VecExp<A>(Load(x + start)));
+		}
+		if (start < n) {
+			double block[kLanes];
+			for (size_t k = 0; k < kLanes; k++) {
+				block[k] = start + k < n ? x[start + k] : 0.;
+			}
+			Store(block, VecExp<A>(Load(block)));
+			for (size_t k = 0; start + k < n; k++) y[start + k] = block[k];
+		}
+	}
+
+	__attribute__((target("avx512f")))
+	void ExpAvx512(const double *x, double *y, const size_t n, 
+		const ReaclibKernel::Accuracy accuracy
+	) {
+		switch (accuracy) {
+			case ReaclibKernel::kFast:
+				ExpBlocks<ReaclibKernel::kFast>(x, y, n);
+				break;
+			case ReaclibKernel::kHigh:
+				ExpBlocks<ReaclibKernel::kHigh>(x, y, n);
+				break;
+			default:
+				ExpBlocks<ReaclibKernel::kFull>(x, y, n);
+		}
+	}
+
+	__attribute__((target("avx2,fma")))
+	void ExpAvx2(const double *x, double *y, const size_t n, 
+		const ReaclibKernel::Accuracy accuracy
+	) {
+		switch (accuracy) {
+			case ReaclibKernel::kFast:
+				ExpBlocks<ReaclibKernel::kFast>(x, y, n);
+				break;
+			case ReaclibKernel::kHigh:
+				ExpBlocks<ReaclibKernel::kHigh>(x, y, n);
+				break;
+			default:
+				ExpBlocks<ReaclibKernel::kFull>(x, y, n);
+		}
+	}
+}
+#endif
+
+namespace {
+	/**Evaluates the temperatures one at a time with the scalar math library.
+	 * This is used when no suitable vector instruction set is available, in
+	 * which case the accuracy is always that of the math library.
+	 */
+	void EvaluateBatchScalar(const double *t9, double *out, 
+		const size_t n, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets,
+		const ReaclibKernel::Accuracy
+	) {
+		for (size_t k = 0; k < n; k++) {
+			out[k] = ReaclibKernel::Evaluate(t9[k], par, setTypes, numSets);
+		}
+	}
+
+	typedef void (*BatchFunction)(const double*, double*, const size_t, 
+		const double*, const ReaclibKernel::SetType*, const unsigned int, 
+		const ReaclibKernel::Accuracy);
+
+	/**Picks the kernel matching the instruction set reported by 
+	 * ReaclibKernel::GetInstructionSet.
+	 */
+	BatchFunction SelectBatchFunction() {
+#if defined(__GNUC__) && defined(__x86_64__)
+		const std::string isa = ReaclibKernel::GetInstructionSet();
+		if (isa == "avx512f") return &EvaluateBatchAvx512;
+		if (isa == "avx2") return &EvaluateBatchAvx2;
+#endif
+		return &EvaluateBatchScalar;
+	}
+
+	/**Computes exp over an array with the scalar math library.
+	 */
+	void ExpScalar(const double *x, double *y, const size_t n, 
+		const ReaclibKernel::Accuracy
+	) {
+		for (size_t k = 0; k < n; k++) y[k] = exp(x[k]);
+	}
+
+	typedef void (*ExpFunction)(const double*, double*, const size_t, 
+		const ReaclibKernel::Accuracy);
+
+	/**Picks the exponential matching the instruction set reported by 
+	 * ReaclibKernel::GetInstructionSet.
+	 */
+	ExpFunction SelectExpFunction() {
+#if defined(__GNUC__) && defined(__x86_64__)
+		const std::string isa = ReaclibKernel::GetInstructionSet();
+		if (isa == "avx512f") return &ExpAvx512;
+		if (isa == "avx2") return &ExpAvx2;
+#endif
+		return &ExpScalar;
+	}
+}
+
+/**The kernel is chosen the first time this is called based on the 
+ * instructions supported by the processor. The vector kernels process the 
+ * temperatures in blocks of ReaclibKernel::kBlockSize and, in the full tier,
+ * agree with ReaclibRate::Evaluate to a few ulp. As in the scalar kernels a 
+ * set whose skipped terms were changed is evaluated in full. A faster tier is selected 
+ * with the accuracy, e.g. inside a network integration:
+ * @code
+ * 	ReaclibKernel::EvaluateBatch(t9, lambda, n, par, setTypes, numSets, 
+ * 		ReaclibKernel::kFast);
+ * @endcode
+ */
+void ReaclibKernel::EvaluateBatch(const double *t9, double *out, 
+	const size_t n, const double *par, const SetType *setTypes, 
+	const unsigned int numSets, const Accuracy accuracy
+) {
+	static const BatchFunction evaluateBatch = SelectBatchFunction();
+	//Resolve the types once for all temperatures, on the stack for most rates.
+	const unsigned int kNumLocal = 64;
+	SetType local[kNumLocal];
+	std::vector<SetType> heap;
+	SetType *resolved = local;
+	if (numSets > kNumLocal) {
+		heap.resize(numSets);
+		resolved = heap.data();
+	}
+	for (unsigned int i = 0; i < numSets; i++) {
+		resolved[i] = ResolveSetType(par + 7 * i, setTypes[i]);
+	}
+	evaluateBatch(t9, out, n, par, resolved, numSets, accuracy);
+}
+
+/**Uses the same vectorized exponential as the batch kernel, or the math 
+ * library if no suitable vector instruction set is available.
+ */
+void ReaclibKernel::Exp(const double *x, double *y, const size_t n, 
+	const Accuracy accuracy
+) {
+	static const ExpFunction exponential = SelectExpFunction();
+	exponential(x, y, n, accuracy);
+}
+
+/**The environment variable REACLIB_ISA may name a lower instruction set than
+ * the processor supports, e.g. to compare the vector kernels with the scalar
+ * one. A higher or unknown name is ignored.
+ */
+const char* ReaclibKernel::GetInstructionSet() {
+	const char *isa = "default";
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (__builtin_cpu_supports("avx512f")) isa = "avx512f";
+	else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		isa = "avx2";
+	}
+#endif
+	const char *requested = getenv("REACLIB_ISA");
+	if (!requested) return isa;
+	const std::string name = requested;
+	if (name == "default") return "default";
+	if (name == "avx2" && strcmp(isa, "default")) return "avx2";
+	return isa;
+}
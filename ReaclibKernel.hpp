@@ -0,0 +1,428 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBKERNEL_H
+#define REACLIBKERNEL_H
+
+#include <cmath>
+#include <cstddef>
+
+#include "TemperatureBasis.hpp"
+
+/**@brief Vectorized evaluation of REACLIB rates over arrays of temperatures.
+ *
+ * The kernels process temperatures in fixed size blocks so that every step,
+ * including the exponential, logarithm and cube root, operates on SIMD 
+ * registers. On x86-64 with GCC or Clang the block kernel is compiled for 
+ * both AVX-512 and AVX2 and the version matching the processor is chosen at
+ * runtime, so a single binary runs on every node. Processors without AVX2 
+ * fall back to a scalar loop over the math library.
+ */
+namespace ReaclibKernel {
+	/// The number of temperatures processed together in one block.
+	static const size_t kBlockSize = 8;
+
+	/// The structure of a REACLIB set, which determines the terms evaluated.
+	enum SetType {
+		kGeneral, ///< All seven parameters contribute.
+		kNonResonant, ///< The T9^-1 term, a1, is zero.
+		kNarrowResonance ///< a2 through a5 are zero and a6 is -3/2.
+	};
+
+	/**The accuracy of the exponential used by the vectorized kernels.
+	 *
+	 * The tier only applies to the batched entry points: 
+	 * ReaclibKernel::EvaluateBatch, ReaclibKernel::Exp and the library 
+	 * evaluation of RateLibraryView. The single temperature evaluators, 
+	 * ReaclibKernel::Evaluate, EvaluateLog, EvaluateWithDerivative and 
+	 * EvaluateGradient, and so ReaclibModel::Evaluate, ReaclibRateN::Evaluate 
+	 * and the TF1 function of ReaclibRate, always call std::exp.
+	 *
+	 * Each set of a rate costs one exponential, so in the batched and library
+	 * evaluations the exponential dominates once a rate has a few sets. The
+	 * argument is reduced to @f$ |r| \le \ln 2 / 2 @f$ in every tier and 
+	 * @f$ e^r @f$ is approximated by a polynomial whose degree sets the 
+	 * accuracy. The bounds below are the largest relative errors of the 
+	 * exponential, measured over the reduced interval, and hold for the sum 
+	 * over the sets. The logarithm and cube root of the temperature are 
+	 * computed once per temperature and are kept at full precision in every
+	 * tier: the exponent terms reach magnitudes of several hundred at low 
+	 * temperatures, which would amplify their errors beyond the bound.
+	 *
+	 * REACLIB fits are only accurate to a few percent, so the faster tiers
+	 * are suitable inside network integrations. Without vector instructions
+	 * the math library is used regardless of the tier.
+	 */
+	enum Accuracy {
+		/// Degree 13 Taylor polynomial, within 2 ulp of std::exp for normal
+		/// results. It is not rounded like the math library.
+		kFull,
+		kHigh, ///< Degree 8 Chebyshev polynomial, relative error below 1.1e-12.
+		kFast ///< Degree 5 Chebyshev polynomial, relative error below 1.1e-7.
+	};
+
+	/// @brief Determines the structural type of a set from its parameters.
+	/// @param[in] a The 7 parameters of the set.
+	/// @return kNarrowResonance if a2 through a5 are zero and a6 is -3/2, 
+	///   kNonResonant if a1 is zero and kGeneral otherwise.
+	inline SetType ClassifySet(const double *a) {
+		if (a[2] == 0 && a[3] == 0 && a[4] == 0 && a[5] == 0 && a[6] == -1.5) {
+			return kNarrowResonance;
+		}
+		return a[1] == 0 ? kNonResonant : kGeneral;
+	}
+
+	/// @brief Returns the type a set is evaluated as: the given type if the 
+	///   terms it skips hold the values it implies, otherwise kGeneral.
+	/// @param[in] a The 7 parameters of the set.
+	/// @param[in] type The structural type of the set.
+	/// @return The type the set is evaluated as.
+	inline SetType ResolveSetType(const double *a, const SetType type) {
+		switch (type) {
+			case kNonResonant:
+				return a[1] == 0 ? type : kGeneral;
+			case kNarrowResonance:
+				return a[2] == 0 && a[3] == 0 && a[4] == 0 && a[5] == 0 
+					&& a[6] == -1.5 ? type : kGeneral;
+			default:
+				return kGeneral;
+		}
+	}
+
+	/// @brief Returns the exponent of a set, including the T9^-3/2 factor of
+	///   narrow resonances.
+	/// @param[in] basis The temperature terms.
+	/// @param[in] a The 7 parameters of the set.
+	/// @param[in] type The structural type of the set.
+	/// @return The exponent of the set contribution.
+	inline double SetExponent(const TemperatureBasis &basis, const double *a,
+		const SetType type
+	);
+
+	/// @brief Evaluates a rate at a single temperature.
+	/// @param[in] basis The temperature terms.
+	/// @param[in] par The 7 * numSets REACLIB parameters.
+	/// @param[in] setTypes The structural type of each set.
+	/// @param[in] numSets The number of sets in the rate.
+	/// @return The reaction rate.
+	inline double Evaluate(const TemperatureBasis &basis, const double *par, 
+		const SetType *setTypes, const unsigned int numSets
+	);
+
+	/// @copydoc Evaluate(const TemperatureBasis&, const double*, const SetType*, const unsigned int)
+	inline double Evaluate(const double t9, const double *par, 
+		const SetType *setTypes, const unsigned int numSets
+	) {
+		return Evaluate(TemperatureBasis(t9), par, setTypes, numSets);
+	}
+
+	/// @brief Evaluates the natural logarithm of a rate at a single 
+	///   temperature.
+	/// @param[in] basis The temperature terms.
+	/// @param[in] par The 7 * numSets REACLIB parameters.
+	/// @param[in] setTypes The structural type of each set.
+	/// @param[in] numSets The number of sets in the rate.
+	/// @return The logarithm of the reaction rate.
+	inline double EvaluateLog(const TemperatureBasis &basis, const double *par, 
+		const SetType *setTypes, const unsigned int numSets
+	);
+
+	/// @copydoc EvaluateLog(const TemperatureBasis&, const double*, const SetType*, const unsigned int)
+	inline double EvaluateLog(const double t9, const double *par, 
+		const SetType *setTypes, const unsigned int numSets
+	) {
+		return EvaluateLog(TemperatureBasis(t9), par, setTypes, numSets);
+	}
+
+	/// @brief Adds a set exponent to a running log-sum-exp.
+	/// @param[in] component The exponent of the set.
+	/// @param[in,out] maximum The largest exponent so far, -HUGE_VAL at first.
+	/// @param[in,out] sum The sum of exp(c - maximum) over the exponents so far.
+	inline void AddLogSumTerm(const double component, double &maximum, double &sum);
+
+	/// @brief Evaluates a rate, or its logarithm, at a single temperature and
+	///   reports the exponent of each set, which is computed only once.
+	/// @param[in] basis The temperature terms.
+	/// @param[in] par The 7 * numSets REACLIB parameters.
+	/// @param[in] setTypes The structural type of each set.
+	/// @param[in] numSets The number of sets in the rate.
+	/// @param[out] exponents Array of numSets values filled with the exponent
+	///   of each set, as returned by SetExponent.
+	/// @param[in] logScale If true the logarithm of the rate is returned.
+	/// @return The same value as Evaluate, or as EvaluateLog if logScale is set.
+	inline double EvaluateWithExponents(const TemperatureBasis &basis, 
+		const double *par, const SetType *setTypes, const unsigned int numSets,
+		double *exponents, const bool logScale = false
+	);
+
+	/// @brief Evaluates a rate and its derivatives with respect to the 
+	///   parameters at a single temperature.
+	/// @param[in] basis The temperature terms.
+	/// @param[in] par The 7 * numSets REACLIB parameters.
+	/// @param[in] setTypes The structural type of each set.
+	/// @param[in] numSets The number of sets in the rate.
+	/// @param[out] grad The 7 * numSets derivatives with respect to par.
+	/// @param[in] logScale If true the logarithm of the rate and its 
+	///   derivatives are computed instead.
+	/// @return The reaction rate, or its logarithm.
+	inline double EvaluateGradient(const TemperatureBasis &basis, 
+		const double *par, const SetType *setTypes, const unsigned int numSets, 
+		double *grad, const bool logScale = false
+	);
+
+	/// @copydoc EvaluateGradient(const TemperatureBasis&, const double*, const SetType*, const unsigned int, double*, const bool)
+	inline double EvaluateGradient(const double t9, const double *par, 
+		const SetType *setTypes, const unsigned int numSets, double *grad,
+		const bool logScale = false
+	) {
+		return EvaluateGradient(TemperatureBasis(t9), par, setTypes, numSets, 
+			grad, logScale);
+	}
+
+	/// @brief Evaluates a rate and its temperature derivative at a single 
+	///   temperature.
+	/// @param[in] basis The temperature terms.
+	/// @param[in] par The 7 * numSets REACLIB parameters.
+	/// @param[in] setTypes The structural type of each set.
+	/// @param[in] numSets The number of sets in the rate.
+	/// @param[out] dRate_dT9 The derivative of the rate with respect to T9.
+	/// @return The reaction rate.
+	inline double EvaluateWithDerivative(const TemperatureBasis &basis, 
+		const double *par, const SetType *setTypes, const unsigned int numSets, 
+		double *dRate_dT9
+	);
+
+	/// @copydoc EvaluateWithDerivative(const TemperatureBasis&, const double*, const SetType*, const unsigned int, double*)
+	inline double EvaluateWithDerivative(const double t9, const double *par, 
+		const SetType *setTypes, const unsigned int numSets, double *dRate_dT9
+	) {
+		return EvaluateWithDerivative(TemperatureBasis(t9), par, setTypes, 
+			numSets, dRate_dT9);
+	}
+
+	/// @brief Evaluates a rate at many temperatures.
+	/// @param[in] t9 Array of n T9 values.
+	/// @param[out] out Array of n values filled with the reaction rate.
+	/// @param[in] n The number of temperatures to evaluate.
+	/// @param[in] par The 7 * numSets REACLIB parameters.
+	/// @param[in] setTypes The structural type of each set.
+	/// @param[in] numSets The number of sets in the rate.
+	/// @param[in] accuracy The accuracy of the exponential.
+	void EvaluateBatch(const double *t9, double *out, const size_t n, 
+		const double *par, const SetType *setTypes, const unsigned int numSets,
+		const Accuracy accuracy = kFull
+	);
+
+	/// @brief Computes the exponential of each value in an array.
+	/// @param[in] x Array of n arguments.
+	/// @param[out] y Array of n values filled with exp(x). May be the same as x.
+	/// @param[in] n The number of values.
+	/// @param[in] accuracy The accuracy of the exponential.
+	void Exp(const double *x, double *y, const size_t n, 
+		const Accuracy accuracy = kFull);
+
+	/// @brief Returns the name of the instruction set selected at runtime.
+	/// @details The environment variable REACLIB_ISA may lower the selection.
+	/// @return One of "avx512f", "avx2" or "default".
+	const char* GetInstructionSet();
+}
+
+/**For narrow resonances the exponent is @f$ a_0 + a_1 / T_9 - 3/2 \ln T_9 @f$,
+ * for non-resonant sets the @f$ T_9^{-1} @f$ term is skipped and otherwise 
+ * all seven terms are summed. A term is only skipped if it holds the value
+ * implied by the type (See ReaclibKernel::ResolveSetType), so a parameter 
+ * released during a fit is never ignored.
+ */
+inline double ReaclibKernel::SetExponent(const TemperatureBasis &basis, 
+	const double *a, const SetType type
+) {
+	typedef TemperatureBasis B;
+	switch (ResolveSetType(a, type)) {
+		case kNarrowResonance:
+			return a[0] + a[1] * basis[B::kInverse] - 1.5 * basis[B::kLog];
+		case kNonResonant:
+			return a[0] + a[2] * basis[B::kInverseThird] + a[3] * basis[B::kThird] 
+				+ a[4] * basis[B::kLinear] + a[5] * basis[B::kFiveThirds] 
+				+ a[6] * basis[B::kLog];
+		default:
+			return a[0] + a[1] * basis[B::kInverse] + a[2] * basis[B::kInverseThird]
+				+ a[3] * basis[B::kThird] + a[4] * basis[B::kLinear] 
+				+ a[5] * basis[B::kFiveThirds] + a[6] * basis[B::kLog];
+	}
+}
+
+/**The temperature terms are taken from the basis and shared by all sets. 
+ * Narrow resonance sets only evaluate @f$ exp(a_0 + a_1 / T_9) @f$ and their 
+ * sum is multiplied by the common factor @f$ T_9^{-3/2} @f$ once. Non-resonant
+ * sets skip the @f$ T_9^{-1} @f$ term. Sets whose skipped terms were changed
+ * are evaluated in full.
+ */
+inline double ReaclibKernel::Evaluate(const TemperatureBasis &basis, 
+	const double *par, const SetType *setTypes, const unsigned int numSets
+) {
+	double reacRate = 0;
+	//Sum of the narrow resonances before applying the T9^-3/2 factor.
+	double resonant = 0;
+	for (unsigned int i = 0; i < numSets; i++) {
+		const double *a = par + 7 * i;
+		if (ResolveSetType(a, setTypes[i]) == kNarrowResonance) {
+			resonant += exp(a[0] + a[1] * basis[TemperatureBasis::kInverse]);
+		}
+		else reacRate += exp(SetExponent(basis, a, setTypes[i]));
+	}
+	return reacRate + resonant * basis.GetT9InvThreeHalves();
+}
+
+/**The logarithm is computed with a log-sum-exp over the set exponents,
+ * @f[
+ * 	\ln \lambda = c_{max} + \ln \sum_n exp(c_n - c_{max})
+ * @f]
+ * where @f$ c_n @f$ is the exponent of set @f$ n @f$. The running maximum is 
+ * updated in a single pass, so the result stays finite where the rate itself
+ * would underflow to zero, e.g. charged particle rates near T9 = 0.01.
+ */
+inline double ReaclibKernel::EvaluateLog(const TemperatureBasis &basis, 
+	const double *par, const SetType *setTypes, const unsigned int numSets
+) {
+	//The largest exponent so far and the sum of exp(c - maximum).
+	double maximum = -HUGE_VAL;
+	double sum = 0;
+	for (unsigned int i = 0; i < numSets; i++) {
+		AddLogSumTerm(SetExponent(basis, par + 7 * i, setTypes[i]), maximum, sum);
+	}
+	return maximum + log(sum);
+}
+
+/**The sum is rescaled whenever a larger exponent is found, so the maximum is
+ * updated in a single pass.
+ */
+inline void ReaclibKernel::AddLogSumTerm(const double component, 
+	double &maximum, double &sum
+) {
+	if (component > maximum) {
+		sum = sum * exp(maximum - component) + 1;
+		maximum = component;
+	}
+	else if (maximum > -HUGE_VAL) sum += exp(component - maximum);
+}
+
+/**The rate is summed as in ReaclibKernel::Evaluate, and its logarithm as in 
+ * ReaclibKernel::EvaluateLog, so the result is identical to theirs. For a 
+ * narrow resonance the exponent is completed with the @f$ T_9^{-3/2} @f$ 
+ * term after its contribution is taken. This lets callers inspect the 
+ * exponents, e.g. for underflow, without evaluating them a second time.
+ */
+inline double ReaclibKernel::EvaluateWithExponents(const TemperatureBasis &basis,
+	const double *par, const SetType *setTypes, const unsigned int numSets,
+	double *exponents, const bool logScale
+) {
+	if (logScale) {
+		double maximum = -HUGE_VAL;
+		double sum = 0;
+		for (unsigned int i = 0; i < numSets; i++) {
+			exponents[i] = SetExponent(basis, par + 7 * i, setTypes[i]);
+			AddLogSumTerm(exponents[i], maximum, sum);
+		}
+		return maximum + log(sum);
+	}
+
+	double reacRate = 0;
+	//Sum of the narrow resonances before applying the T9^-3/2 factor.
+	double resonant = 0;
+	for (unsigned int i = 0; i < numSets; i++) {
+		const double *a = par + 7 * i;
+		if (ResolveSetType(a, setTypes[i]) == kNarrowResonance) {
+			const double exponent = a[0] + a[1] * basis[TemperatureBasis::kInverse];
+			resonant += exp(exponent);
+			exponents[i] = exponent - 1.5 * basis[TemperatureBasis::kLog];
+		}
+		else {
+			exponents[i] = SetExponent(basis, a, setTypes[i]);
+			reacRate += exp(exponents[i]);
+		}
+	}
+	return reacRate + resonant * basis.GetT9InvThreeHalves();
+}
+
+/**The derivative of the rate with respect to parameter @f$ a_{n,i} @f$ is 
+ * the contribution of set @f$ n @f$ multiplied by the corresponding 
+ * temperature term,
+ * @f[
+ * 	\frac{\partial \lambda}{\partial a_{n,i}} = e^{c_n} T_9^{(2i-5)/3},
+ * 	\quad
+ * 	\frac{\partial \lambda}{\partial a_{n,0}} = e^{c_n},
+ * 	\quad
+ * 	\frac{\partial \lambda}{\partial a_{n,6}} = e^{c_n} \ln T_9.
+ * @f]
+ * Derivatives are returned for every parameter, including those held fixed 
+ * by the set type. For the logarithm each contribution is divided by the 
+ * rate, which is done relative to the largest exponent to avoid underflow.
+ */
+inline double ReaclibKernel::EvaluateGradient(const TemperatureBasis &basis, 
+	const double *par, const SetType *setTypes, const unsigned int numSets, 
+	double *grad, const bool logScale
+) {
+	//Store the exponent of each set in the a0 slot of the gradient.
+	double maximum = -HUGE_VAL;
+	for (unsigned int i = 0; i < numSets; i++) {
+		grad[7 * i] = SetExponent(basis, par + 7 * i, setTypes[i]);
+		if (grad[7 * i] > maximum) maximum = grad[7 * i];
+	}
+
+	//The linear rate is summed directly, the logarithm relative to the maximum.
+	const double offset = logScale && maximum > -HUGE_VAL ? maximum : 0;
+	double sum = 0;
+	for (unsigned int i = 0; i < numSets; i++) {
+		grad[7 * i] = exp(grad[7 * i] - offset);
+		sum += grad[7 * i];
+	}
+	const double norm = logScale ? 1. / sum : 1.;
+	for (unsigned int i = 0; i < numSets; i++) {
+		const double weight = grad[7 * i] * norm;
+		for (unsigned int j = 0; j < TemperatureBasis::kNumTerms; j++) {
+			grad[7 * i + j] = weight * basis[j];
+		}
+	}
+	return logScale ? offset + log(sum) : sum;
+}
+
+/**The temperature derivative is accumulated in the same pass as the rate
+ * using the logarithmic derivative of each set,
+ * @f[
+ * 	T_9 \frac{dc_n}{dT_9} = \sum_{i=1}^5 \frac{2i-5}{3} a_{n,i} 
+ * 		T_9^{(2i-5)/3} + a_{n,6},
+ * 	\quad
+ * 	\frac{d\lambda}{dT_9} = \frac{1}{T_9} \sum_n e^{c_n} 
+ * 		T_9 \frac{dc_n}{dT_9}.
+ * @f]
+ */
+inline double ReaclibKernel::EvaluateWithDerivative(
+	const TemperatureBasis &basis, const double *par, const SetType *setTypes, 
+	const unsigned int numSets, double *dRate_dT9
+) {
+	typedef TemperatureBasis B;
+	double reacRate = 0;
+	//Sum of each set contribution times its logarithmic derivative.
+	double derivative = 0;
+	for (unsigned int i = 0; i < numSets; i++) {
+		const double *a = par + 7 * i;
+		const SetType type = ResolveSetType(a, setTypes[i]);
+		double logDerivative;
+		if (type == kNarrowResonance) {
+			logDerivative = -a[1] * basis[B::kInverse] - 1.5;
+		}
+		else {
+			logDerivative = (a[3] * basis[B::kThird] - a[2] * basis[B::kInverseThird]) / 3.
+				+ a[4] * basis[B::kLinear] + 5. / 3. * a[5] * basis[B::kFiveThirds] 
+				+ a[6];
+			if (type != kNonResonant) logDerivative -= a[1] * basis[B::kInverse];
+		}
+		const double contribution = exp(SetExponent(basis, a, type));
+		reacRate += contribution;
+		derivative += contribution * logDerivative;
+	}
+	*dRate_dT9 = derivative / basis.GetT9();
+	return reacRate;
+}
+
+#endif //REACLIBKERNEL_H
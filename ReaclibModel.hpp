@@ -0,0 +1,373 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBMODEL_H
+#define REACLIBMODEL_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "ReaclibKernel.hpp"
+#include "TemperatureBasis.hpp"
+
+/**@brief The parameters of a REACLIB rate built from physical quantities,
+ *   without any dependence on ROOT.
+ * @author Karl Smith
+ *
+ * The model holds the 7 * (numResonances + 1) REACLIB parameters, whether
+ * each one is fixed and the structural type of each set. The parameters are
+ * initialized from the reactant charges and reduced mass, S(0) and the
+ * resonance energies and strengths in the same way as ReaclibRate, which is
+ * a TF1 adapter over this class. Programs that only evaluate rates can use
+ * the model directly and need not link against ROOT:
+ * @code
+ * 	ReaclibModel model(1, 6, 1, 0.923);
+ * 	model.SetSFactor(1.5e-3);
+ * 	model.SetResonance(0, 0.422, 8.6e-3);
+ * 	double lambda = model.Evaluate(0.2);
+ * @endcode
+ * The single temperature methods are inline. ReaclibModel::EvaluateBatch 
+ * calls the vectorized kernels, so ReaclibKernel.cpp must be compiled in.
+ */
+class ReaclibModel {
+	public:
+		/// @brief Charged particle constructor.
+		/// @param[in] numResonances The number of sets of resonance to add in
+		///   addition to the non-resonant set.
+		/// @param[in] z1 The atomic number of the target.
+		/// @param[in] z2 The atomic number of the reactant.
+		/// @param[in] mu The reduced mass of the reactants in amu.
+		ReaclibModel(const unsigned int numResonances,
+			const unsigned int z1, const unsigned int z2, const float mu
+		);
+
+		/// @brief Sets the best guess for the S-factor term S(0).
+		/// @param[in] s0_MeVb The value for the S-factor in MeV-b at energy zero,
+		///   S(0).
+		void SetSFactor(const float s0_MeVb);
+
+		/// @brief Set parameters for the specified narrow resonance.
+		/// @param[in] resonanceId The ID of the associated resonance, begins at 0.
+		/// @param[in] energy The resonance energy in MeV.
+		/// @param[in] strength The resonance strength.
+		void SetResonance(const unsigned int resonanceId,
+			const float energy, const float strength
+		);
+
+		/// @brief Returns the S-factor, S(0), determined from the parameters.
+		/// @return The S-factor in MeV-b.
+		double GetSFactor() const;
+
+		/// @brief Returns the reduced mass, determined from the parameters.
+		/// @return The reduced mass in amu.
+		double GetReducedMass() const;
+
+		/// @brief Returns the resonance energy of the specified resonance set.
+		/// @param[in] resonanceId The ID of the resonance to query, starts at 0.
+		/// @return The resonance energy. If the resonance ID is invalid -1 is
+		///   returned.
+		double GetResonanceEnergy(const unsigned int resonanceId) const;
+
+		/// @brief Returns the resonance strength of the specified resonance set.
+		/// @param[in] resonanceId The ID of the resonance to query, starts at 0.
+		/// @return The resonance strength. If the resonance ID is invalid -1 is
+		///   returned.
+		double GetResonanceStrength(const unsigned int resonanceId) const;
+
+		/// @brief Returns the number of resonance sets.
+		unsigned int GetNumResonances() const {return numResonances_;}
+
+		/// @brief Returns the number of sets, including the non-resonant set.
+		unsigned int GetNumSets() const {return numResonances_ + 1;}
+
+		/// @brief Returns the number of parameters, 7 per set.
+		unsigned int GetNumParameters() const {return par_.size();}
+
+		/// @brief Returns the atomic number of the target.
+		unsigned int GetZ1() const {return z1_;}
+
+		/// @brief Returns the atomic number of the reactant.
+		unsigned int GetZ2() const {return z2_;}
+
+		/// @brief Returns the reduced mass the model was constructed with in amu.
+		float GetMu() const {return mu_amu_;}
+
+		/// @brief Returns the specified parameter.
+		/// @param[in] i The parameter index, 7 * set + term.
+		double GetParameter(const unsigned int i) const {return par_[i];}
+
+		/// @brief Returns a pointer to the GetNumParameters() parameters.
+		const double* GetParameters() const {return par_.data();}
+
+		/// @brief Sets a parameter without changing whether it is fixed.
+		/// @param[in] i The parameter index, 7 * set + term.
+		/// @param[in] value The parameter value.
+		void SetParameter(const unsigned int i, const double value) {
+			par_[i] = value;
+		}
+
+		/// @brief Sets a parameter and fixes it.
+		/// @param[in] i The parameter index, 7 * set + term.
+		/// @param[in] value The parameter value.
+		void FixParameter(const unsigned int i, const double value) {
+			par_[i] = value;
+			fixed_[i] = true;
+		}
+
+		/// @brief Allows a parameter to vary in a fit.
+		/// @param[in] i The parameter index, 7 * set + term.
+		void ReleaseParameter(const unsigned int i) {fixed_[i] = false;}
+
+		/// @brief Returns true if the parameter is fixed.
+		/// @param[in] i The parameter index, 7 * set + term.
+		bool IsFixed(const unsigned int i) const {return fixed_[i];}
+
+		/// @brief Replaces the parameters and structural types of all sets.
+		///   Whether each parameter is fixed is unchanged.
+		/// @param[in] par The GetNumParameters() parameters.
+		/// @param[in] setTypes The structural type of each set.
+		void SetSets(const double *par, const ReaclibKernel::SetType *setTypes);
+
+		/// @brief Sets the structural type of a set.
+		/// @param[in] setId The ID of the set, 0 is the non-resonant set.
+		/// @param[in] type The structural type of the set.
+		void SetSetType(const unsigned int setId,
+			const ReaclibKernel::SetType type
+		) {
+			if (setId <= numResonances_) setTypes_[setId] = type;
+		}
+
+		/// @brief Returns the structural type of a set.
+		/// @param[in] setId The ID of the set, 0 is the non-resonant set.
+		/// @return The structural type. If the set ID is invalid
+		///   ReaclibKernel::kGeneral is returned.
+		ReaclibKernel::SetType GetSetType(const unsigned int setId) const {
+			if (setId > numResonances_) return ReaclibKernel::kGeneral;
+			return setTypes_[setId];
+		}
+
+		/// @brief Returns a pointer to the GetNumSets() set types.
+		const ReaclibKernel::SetType* GetSetTypes() const {
+			return setTypes_.data();
+		}
+
+		/// @brief Evaluates the rate.
+		/// @param[in] basis The temperature terms.
+		/// @return The reaction rate.
+		double Evaluate(const TemperatureBasis &basis) const {
+			return ReaclibKernel::Evaluate(basis, par_.data(), setTypes_.data(),
+				GetNumSets());
+		}
+
+		/// @brief Evaluates the rate.
+		/// @param[in] t9 The temperature in GK.
+		/// @return The reaction rate.
+		double Evaluate(const double t9) const {
+			return Evaluate(TemperatureBasis(t9));
+		}
+
+		/// @brief Evaluates the natural logarithm of the rate.
+		/// @param[in] t9 The temperature in GK.
+		/// @return The logarithm of the reaction rate.
+		double EvaluateLog(const double t9) const {
+			return ReaclibKernel::EvaluateLog(t9, par_.data(), setTypes_.data(),
+				GetNumSets());
+		}
+
+		/// @brief Evaluates the rate and its temperature derivative.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[out] dRate_dT9 The derivative of the rate with respect to T9.
+		/// @return The reaction rate.
+		double EvaluateWithDerivative(const double t9, double *dRate_dT9) const {
+			return ReaclibKernel::EvaluateWithDerivative(t9, par_.data(),
+				setTypes_.data(), GetNumSets(), dRate_dT9);
+		}
+
+		/// @brief Evaluates the rate and its derivatives with respect to every
+		///   parameter.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[out] grad Array of GetNumParameters() derivatives.
+		/// @param[in] logScale If true the rate and derivatives are of the
+		///   logarithm of the rate.
+		/// @return The reaction rate, or its logarithm.
+		double EvaluateGradient(const double t9, double *grad,
+			const bool logScale = false
+		) const {
+			return ReaclibKernel::EvaluateGradient(t9, par_.data(),
+				setTypes_.data(), GetNumSets(), grad, logScale);
+		}
+
+		/// @brief Evaluates the rate at many temperatures.
+		/// @param[in] t9 Array of n T9 values.
+		/// @param[out] out Array of n values filled with the reaction rate.
+		/// @param[in] n The number of temperatures to evaluate.
+		/// @param[in] accuracy The accuracy of the exponential.
+		void EvaluateBatch(const double *t9, double *out, const size_t n,
+			const ReaclibKernel::Accuracy accuracy = ReaclibKernel::kFull
+		) const {
+			ReaclibKernel::EvaluateBatch(t9, out, n, par_.data(), setTypes_.data(),
+				GetNumSets(), accuracy);
+		}
+
+		///Constant used for non-resonant a0 term. In units of @f$ cm^3 s^{-1} mole^{-1} MeV^{-1} barn^{-1} @f$
+		static constexpr float kB = 7.8318E9;
+		///Constant used for resonant a0 term. In units of @f$ cm^3 s^{-1} mole^{-1} MeV^{-1} @f$
+		static constexpr float kD = 1.5394E11;
+
+	private:
+		unsigned int numResonances_; ///< The number of resonance sets for this rate.
+		unsigned int z1_; ///< Atomic number of the target.
+		unsigned int z2_; ///< Atomic number of the reactant.
+		float mu_amu_; ///< Reduced mass of the reactants in amu.
+		std::vector<double> par_; ///< The REACLIB parameters.
+		std::vector<char> fixed_; ///< Whether each parameter is fixed.
+		std::vector<ReaclibKernel::SetType> setTypes_; ///< The structural type of each set.
+};
+
+/** Constructor for charged particle reactions. Specifies the number of
+ *  resonances as well as the charge and reduced mass of the reactants.
+ *
+ *  For charged particle reactions the non-resonant set of parameters has a0
+ *  fixed based on S(0) (See ReaclibModel::SetSFactor). The a1 term is set based
+ *  on the charge and mass of the reactants in the following form:
+ *  \f[
+ *    -4.2486 (Z_1^2 Z_2^2 \mu)^{1/3}
+ *  \f]
+ *  where \f$ Z_1 \f$ and \f$ Z_2 \f$ are the charge and \f$ \mu \f$ of the
+ *  reaction reactants.
+ *  The a3 through a5 terms are allowed to float and the a6 term is set to -2/3.
+ *
+ *  For narrow resonances the a0 and a1 term are set based on the resonance
+ *  energy and strength (See ReaclibModel::SetResonance). The a2 through a5
+ *  terms are fixed to 0. Finally, a6 is set to -3/2.
+ *
+ *  The non-resonant set is marked as ReaclibKernel::kNonResonant and each
+ *  resonance set as ReaclibKernel::kNarrowResonance so that the fixed zero
+ *  terms are skipped during evaluation (See ReaclibModel::SetSetType).
+ *
+ *  \note Neutron induced non-resonant reaction rates are not yet supported.
+ */
+inline ReaclibModel::ReaclibModel(const unsigned int numResonances,
+	const unsigned int z1, const unsigned int z2, const float mu
+) :
+	numResonances_(numResonances),
+	z1_(z1),
+	z2_(z2),
+	mu_amu_(mu),
+	par_(7 * (numResonances + 1), 0),
+	fixed_(7 * (numResonances + 1), false),
+	setTypes_(numResonances + 1, ReaclibKernel::kNarrowResonance)
+{
+	//First set the non-resonant set of terms.
+	//Set a0 as we do not yet know S(0).
+	SetParameter(0, log(kB * pow(z1_ * z2_ * mu_amu_, 1./3.)));
+	FixParameter(1, 0);
+	FixParameter(2, -4.2486 * pow(pow(z1_ * z2_, 2) * mu_amu_, 1./3.));
+	//Parameters a3 through a5 are allowed to vary.
+	FixParameter(6, -2./3.);
+	setTypes_[0] = ReaclibKernel::kNonResonant;
+
+	//Now we set all resonant set terms.
+	for (unsigned int i=0;i<numResonances_;i++) {
+		//Set a0 as we do not yet know the strength.
+		SetParameter(7 * (i+1) + 0, log(kD * pow(mu_amu_, -3./2.)));
+		//Set a1 as we do not yet know the resonance energy.
+		SetParameter(7 * (i+1) + 1, -11.6045);
+		for (int j=2;j<=5;j++) {
+			FixParameter(7 * (i+1) + j, 0);
+		}
+		FixParameter(7 * (i+1) + 6, -3./2.);
+	}
+}
+
+/** Sets the term (a0) of the non-resonant set associated with the s-factor at
+ *  energy zero, S(0). The a0 term takes the form
+ *  \f[
+ *     ln[B (Z_1 Z_2 \mu)^{1/3} S(0)]
+ *  \f]
+ *  where \f$ B = 7.8318 \times 10^9 cm^3 s^{-1} mole^{-1} MeV^{-1} \f$,
+ *  \f$ Z_1 \f$ and \f$ Z_2 \f$ are the charge of the reactants, \f$ \mu \f$ is
+ *  the reduced mass of the reactants and \f$ S(0) \f$ is the value of the
+ *  S-factor evaluated at an energy of zero.
+ *
+ *  The parameter is fixed, but can be allowed to float by
+ *  using the following: @code ReaclibModel::ReleaseParameter(0); @endcode
+ */
+inline void ReaclibModel::SetSFactor(const float s0_MeVb) {
+	FixParameter(0, log(kB * pow(z1_ * z2_ * mu_amu_, 1./3.) * s0_MeVb));
+}
+
+/**Sets the terms for a resonance set. Specifically, a0 and a1 are set using
+ * the resonance strength and energy.
+ *
+ * For narrow resonances the a0 term takes on the following form:
+ * \f[
+ *   ln[D \mu^{-3/2} \omega\gamma]
+ * \f]
+ * where \f$ D = 1.5394 \times 10^{11} cm^3 s^{-1} mole^{-1} MeV^{-1} \f$,
+ * \f$ \mu \f$ is the reactants reduced mass, and \f$ \omega \gamma \f$ is the
+ * narrow resonance strength.
+ *
+ * The a1 term takes on the following form:
+ * \f[
+ *   -11.6045 E_r
+ * \f]
+ * where \f$ E_r \f$ is the resonance energy.
+ *
+ * The corresponding parameters are fixed, but can be allowed to float by
+ * using the following:
+ * @code
+ * 	ReaclibModel::ReleaseParameter(7 * (resonanceId + 1) + 0);
+ * 	ReaclibModel::ReleaseParameter(7 * (resonanceId + 1) + 1);
+ * @endcode
+ */
+inline void ReaclibModel::SetResonance(
+	const unsigned int resonanceId, const float energy, const float strength
+) {
+	if (resonanceId < numResonances_) {
+		FixParameter(7 * (resonanceId+1) + 0, log(kD * pow(mu_amu_, -3./2.) * strength));
+		FixParameter(7 * (resonanceId+1) + 1, -11.6045 * energy);
+	}
+}
+
+/**Extracts the reduced mass from the a2 term assuming that Z1 and Z2 are fixed.
+ */
+inline double ReaclibModel::GetReducedMass() const {
+	return pow(GetParameter(2) / -4.2486, 3.) / pow(z1_ * z2_, 2.);
+}
+
+/**Extracts the S-factor term at zero energy, S(0), from the term a0 using the
+ * reduced mass determined from a2.
+ */
+inline double ReaclibModel::GetSFactor() const {
+	float mu_amu = GetReducedMass();
+	return exp(GetParameter(0)) / kB / pow(z1_ * z2_ * mu_amu, 1./3.);
+}
+
+/**Extracts the resonance energy from the a1 term of the corresponding
+ * resonance set.
+ */
+inline double ReaclibModel::GetResonanceEnergy(const unsigned int resonanceId) const {
+	if (resonanceId >= numResonances_) return -1;
+	return GetParameter(7 * (resonanceId+1) + 1) / -11.6045;
+}
+
+/**Extracts the resonance strength from the a0 term of the corresponding
+ * resonance set using the reduced mass determined from the a2 term of the
+ * non-resonant set.
+ */
+inline double ReaclibModel::GetResonanceStrength(const unsigned int resonanceId) const {
+	if (resonanceId >= numResonances_) return -1;
+	float mu_amu = GetReducedMass();
+	return exp(GetParameter(7 * (resonanceId+1) + 0)) / kD / pow(mu_amu, -3./2.);
+}
+
+inline void ReaclibModel::SetSets(
+	const double *par, const ReaclibKernel::SetType *setTypes
+) {
+	for (size_t i=0; i<par_.size(); i++) par_[i] = par[i];
+	for (unsigned int i=0; i<=numResonances_; i++) setTypes_[i] = setTypes[i];
+}
+
+#endif //REACLIBMODEL_H
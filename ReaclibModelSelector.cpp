@@ -0,0 +1,152 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibModelSelector.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include "ParallelFor.hpp"
+
+ReaclibModelSelector::ReaclibModelSelector(const unsigned int z1,
+	const unsigned int z2, const float mu
+) :
+	z1_(z1),
+	z2_(z2),
+	mu_amu_(mu),
+	sFactor_(0),
+	maxResonances_(3),
+	minEnergy_(0.05),
+	maxEnergy_(3),
+	strength_(1e-3),
+	criterion_(kAICc),
+	maxDeviation_(0.05),
+	numThreads_(0)
+{
+
+}
+
+/**The resonances start at energies spaced logarithmically between the
+ * limits of the energy range, and their energies and strengths are free.
+ */
+ReaclibModel ReaclibModelSelector::MakeModel(
+	const unsigned int numResonances
+) const {
+	ReaclibModel model(numResonances, z1_, z2_, mu_amu_);
+	if (sFactor_ > 0) model.SetSFactor(sFactor_);
+	for (unsigned int i = 0; i < numResonances; i++) {
+		const double fraction = numResonances > 1 ? i / (numResonances - 1.) : 0.5;
+		const float energy = minEnergy_ * pow(maxEnergy_ / minEnergy_, fraction);
+		model.SetResonance(i, energy, strength_);
+		model.ReleaseParameter(7 * (i + 1) + 0);
+		model.ReleaseParameter(7 * (i + 1) + 1);
+	}
+	return model;
+}
+
+/**With uncertainties the criterion is based on chi-square. Without them the
+ * scale of chi-square is unknown and @f$ n \ln(\chi^2 / n) @f$ is used
+ * instead. The number of parameters k is the number of free parameters.
+ */
+double ReaclibModelSelector::ComputeCriterion(
+	const ReaclibFitter::Result &result, const size_t n, const bool weighted
+) const {
+	const double k = n - result.ndf;
+	const double minimum = std::numeric_limits<double>::min();
+	double base = weighted ? result.chi2
+		: n * log(result.chi2 / n > minimum ? result.chi2 / n : minimum);
+	switch (criterion_) {
+		case kAIC:
+			return base + 2 * k;
+		case kBIC:
+			return base + k * log(static_cast<double>(n));
+		default:
+			if (n <= k + 1) return std::numeric_limits<double>::infinity();
+			return base + 2 * k + 2 * k * (k + 1) / (n - k - 1);
+	}
+}
+
+/**The candidate without resonances is fit from a single start, as only the
+ * a0 term would be perturbed. The starts of every candidate are run in one
+ * pass over the thread pool, recording only their chi-square. The best start
+ * of each candidate is then fit again to obtain its model and errors, which
+ * is deterministic as the perturbation depends only on the start index.
+ */
+int ReaclibModelSelector::Select(const double *t9, const double *rate,
+	const double *sigma, const size_t n
+) {
+	const unsigned int numCandidates = maxResonances_ + 1;
+	const unsigned int numStarts = multiStart_.GetNumStarts() ? multiStart_.GetNumStarts() : 1;
+	std::vector<ReaclibModel> initial;
+	std::vector<size_t> firstStart(numCandidates + 1, 0);
+	for (unsigned int c = 0; c < numCandidates; c++) {
+		initial.push_back(MakeModel(c));
+		firstStart[c + 1] = firstStart[c] + (c == 0 ? 1 : numStarts);
+	}
+
+	//Fit every start of every candidate.
+	const double kFailed = std::numeric_limits<double>::infinity();
+	std::vector<double> startChi2(firstStart.back(), kFailed);
+	const unsigned int threads = ParallelThreads(numThreads_, startChi2.size());
+	std::vector<ReaclibFitter> fitters(threads, multiStart_.GetFitter());
+	ParallelFor(startChi2.size(), threads, [&](const size_t job, const unsigned int thread) {
+		unsigned int c = 0;
+		while (job >= firstStart[c + 1]) c++;
+		ReaclibModel model = initial[c];
+		multiStart_.Perturb(model, job - firstStart[c]);
+		ReaclibFitter::Result result;
+		if (fitters[thread].Fit(model, t9, rate, sigma, n, &result)) {
+			startChi2[job] = result.chi2;
+		}
+	});
+
+	//Refit the best start of each candidate and compare it to the data.
+	candidates_.assign(numCandidates, Candidate());
+	models_ = initial;
+	errors_.assign(numCandidates, std::vector<double>());
+	ParallelFor(numCandidates, threads, [&](const size_t c, const unsigned int thread) {
+		Candidate &candidate = candidates_[c];
+		candidate.numResonances = c;
+		candidate.success = false;
+		candidate.criterion = kFailed;
+		candidate.maxDeviation = kFailed;
+
+		size_t best = firstStart[c];
+		for (size_t s = firstStart[c]; s < firstStart[c + 1]; s++) {
+			if (startChi2[s] < startChi2[best]) best = s;
+		}
+		if (!std::isfinite(startChi2[best])) return;
+
+		ReaclibModel &model = models_[c];
+		multiStart_.Perturb(model, best - firstStart[c]);
+		if (!fitters[thread].Fit(model, t9, rate, sigma, n, &candidate.result)) return;
+		errors_[c] = fitters[thread].GetErrors();
+
+		std::vector<double> evaluated(n);
+		model.EvaluateBatch(t9, evaluated.data(), n);
+		double maxDeviation = 0;
+		for (size_t i = 0; i < n; i++) {
+			const double deviation = fabs(evaluated[i] - rate[i]) / rate[i];
+			if (!(deviation <= maxDeviation)) maxDeviation = deviation;
+		}
+		candidate.maxDeviation = maxDeviation;
+		candidate.criterion = ComputeCriterion(candidate.result, n, sigma != 0);
+		candidate.success = true;
+	});
+
+	//Prefer the lowest criterion among the candidates within the tolerance.
+	int selected = -1, closest = -1;
+	for (unsigned int c = 0; c < numCandidates; c++) {
+		const Candidate &candidate = candidates_[c];
+		if (!candidate.success) continue;
+		if (closest < 0 || candidate.maxDeviation < candidates_[closest].maxDeviation) {
+			closest = c;
+		}
+		if (candidate.maxDeviation <= maxDeviation_ && (selected < 0 ||
+			candidate.criterion < candidates_[selected].criterion)) {
+			selected = c;
+		}
+	}
+	return selected >= 0 ? selected : closest;
+}
@@ -0,0 +1,150 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBMODELSELECTOR_H
+#define REACLIBMODELSELECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibMultiStart.hpp"
+
+/**@brief Chooses the number of narrow resonance sets needed to describe a
+ *   tabulated rate.
+ * @author Karl Smith
+ *
+ * The data are fit with 0 through K resonance sets. The resonances of each
+ * candidate start at energies spaced logarithmically over the energy range
+ * and their energies and strengths are fit. Every candidate is fit from the
+ * starts of ReaclibMultiStart, and the starts of all candidates are run
+ * together over a pool of threads.
+ *
+ * Candidates are compared by an information criterion, which rewards a lower
+ * chi-square and penalizes the additional parameters of each resonance. The
+ * candidate with the lowest criterion among those whose largest relative
+ * deviation from the data is within the tolerance is selected. If no
+ * candidate reaches the tolerance the one with the smallest deviation is
+ * selected.
+ * @code
+ * 	ReaclibModelSelector selector(6, 1, 0.923);
+ * 	selector.SetMaxResonances(3);
+ * 	int best = selector.Select(t9, rate, sigma, numPoints);
+ * 	if (best >= 0) model = selector.GetModel(best);
+ * @endcode
+ */
+class ReaclibModelSelector {
+	public:
+		/// The information criteria used to compare candidates.
+		enum Criterion {
+			kAIC, ///< Akaike information criterion, penalty 2k.
+			kAICc, ///< AIC corrected for small samples.
+			kBIC ///< Bayesian information criterion, penalty k ln(n).
+		};
+
+		/// @brief The fit of one candidate resonance count.
+		struct Candidate {
+			unsigned int numResonances; ///< The number of resonance sets.
+			bool success; ///< True if the candidate was fit.
+			ReaclibFitter::Result result; ///< The outcome of the best start.
+			double criterion; ///< The information criterion.
+			double maxDeviation; ///< The largest relative deviation from the data.
+		};
+
+		/// @brief Constructor.
+		/// @param[in] z1 The atomic number of the target.
+		/// @param[in] z2 The atomic number of the reactant.
+		/// @param[in] mu The reduced mass of the reactants in amu.
+		ReaclibModelSelector(const unsigned int z1, const unsigned int z2,
+			const float mu);
+
+		/// @brief Fixes S(0) in every candidate. By default a0 is fit.
+		/// @param[in] s0_MeVb The S-factor at zero energy in MeV-b.
+		void SetSFactor(const float s0_MeVb) {sFactor_ = s0_MeVb;}
+
+		/// @brief Sets the largest number of resonance sets tried, 3 by default.
+		void SetMaxResonances(const unsigned int maxResonances) {
+			maxResonances_ = maxResonances;
+		}
+
+		/// @brief Sets the range of the initial resonance energies.
+		/// @param[in] minEnergy The lowest energy in MeV, 0.05 by default.
+		/// @param[in] maxEnergy The highest energy in MeV, 3 by default.
+		void SetEnergyRange(const float minEnergy, const float maxEnergy) {
+			minEnergy_ = minEnergy;
+			maxEnergy_ = maxEnergy;
+		}
+
+		/// @brief Sets the initial resonance strength, 1e-3 MeV by default.
+		void SetStrength(const float strength) {strength_ = strength;}
+
+		/// @brief Sets the information criterion, kAICc by default.
+		void SetCriterion(const Criterion criterion) {criterion_ = criterion;}
+
+		/// @brief Sets the largest acceptable relative deviation, 0.05 by default.
+		void SetMaxDeviation(const double maxDeviation) {maxDeviation_ = maxDeviation;}
+
+		/// @brief Sets the number of threads, 0 by default for the number of
+		///   hardware threads.
+		void SetNumThreads(const unsigned int numThreads) {numThreads_ = numThreads;}
+
+		/// @brief Returns the multi-start and fitter settings of each candidate.
+		///   The number of threads is ignored.
+		ReaclibMultiStart& GetMultiStart() {return multiStart_;}
+
+		/// @brief Fits every candidate and selects the resonance count.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] sigma Array of n uncertainties of the rates, may be null.
+		/// @param[in] n The number of points.
+		/// @return The selected number of resonances, or -1 if no candidate
+		///   could be fit.
+		int Select(const double *t9, const double *rate, const double *sigma,
+			const size_t n);
+
+		/// @brief Returns the number of candidates of the last selection.
+		size_t GetNumCandidates() const {return candidates_.size();}
+
+		/// @brief Returns the candidate with the given number of resonances.
+		const Candidate& GetCandidate(const unsigned int numResonances) const {
+			return candidates_[numResonances];
+		}
+
+		/// @brief Returns the fitted model with the given number of resonances.
+		const ReaclibModel& GetModel(const unsigned int numResonances) const {
+			return models_[numResonances];
+		}
+
+		/// @brief Returns the parameter errors of the model with the given
+		///   number of resonances.
+		const std::vector<double>& GetErrors(const unsigned int numResonances) const {
+			return errors_[numResonances];
+		}
+
+	private:
+		/// @brief Builds the initial model of a candidate.
+		ReaclibModel MakeModel(const unsigned int numResonances) const;
+
+		/// @brief Computes the information criterion of a fit.
+		double ComputeCriterion(const ReaclibFitter::Result &result,
+			const size_t n, const bool weighted) const;
+
+		unsigned int z1_; ///< Atomic number of the target.
+		unsigned int z2_; ///< Atomic number of the reactant.
+		float mu_amu_; ///< Reduced mass of the reactants in amu.
+		float sFactor_; ///< S(0) in MeV-b, or zero if a0 is fit.
+		unsigned int maxResonances_; ///< The largest number of resonances tried.
+		float minEnergy_; ///< The lowest initial resonance energy in MeV.
+		float maxEnergy_; ///< The highest initial resonance energy in MeV.
+		float strength_; ///< The initial resonance strength.
+		Criterion criterion_; ///< The information criterion.
+		double maxDeviation_; ///< The largest acceptable relative deviation.
+		unsigned int numThreads_; ///< The number of threads, 0 for all.
+		ReaclibMultiStart multiStart_; ///< The multi-start and fitter settings.
+		std::vector<Candidate> candidates_; ///< The candidates of the last selection.
+		std::vector<ReaclibModel> models_; ///< The fitted model of each candidate.
+		std::vector<std::vector<double> > errors_; ///< The parameter errors of each candidate.
+};
+
+#endif //REACLIBMODELSELECTOR_H
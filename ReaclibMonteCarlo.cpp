@@ -0,0 +1,124 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibMonteCarlo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "ParallelFor.hpp"
+
+namespace {
+	/**Returns the percentile of sorted values, interpolating linearly
+	 * between neighbouring values. Percentiles outside [0, 1] are clamped.
+	 */
+	double Percentile(const std::vector<double> &sorted, const double p) {
+		const double position = std::min(std::max(p, 0.), 1.) * (sorted.size() - 1);
+		const size_t below = static_cast<size_t>(position);
+		if (below + 1 >= sorted.size()) return sorted.back();
+		const double fraction = position - below;
+		return sorted[below] + fraction * (sorted[below + 1] - sorted[below]);
+	}
+}
+
+ReaclibMonteCarlo::ReaclibMonteCarlo() :
+	numSamples_(1000),
+	batchSize_(1024),
+	numThreads_(0),
+	seed_(0),
+	correlated_(true)
+{
+	const double percentiles[] = {0.025, 0.16, 0.5, 0.84, 0.975};
+	bands_.percentiles.assign(percentiles, percentiles + 5);
+}
+
+/**The samples of each batch are fit concurrently, each thread with its own
+ * fitter and realization buffers, and every sample stores its parameters and
+ * fitted rate in its own row. The realizations are fit in log space with the
+ * uncertainty @f$ \sigma_i = r_i' \ln f.u._i @f$.
+ */
+bool ReaclibMonteCarlo::Run(const ReaclibModel &model, const double *t9,
+	const double *rate, const double *factor, const size_t n,
+	const BandHandler &handler
+) {
+	//Empty the bands first, so a run that fits nothing does not report those
+	//of the previous run.
+	const unsigned int numPar = model.GetNumParameters();
+	bands_.numParameters = numPar;
+	bands_.t9.assign(t9, t9 + n);
+	ComputeBands(0);
+	for (size_t i = 0; i < n; i++) {
+		if (!(rate[i] > 0) || !(factor[i] > 1)) return false;
+	}
+	parameters_.assign(numSamples_ * numPar, 0);
+	rates_.assign(numSamples_ * n, 0);
+	success_.assign(numSamples_, false);
+
+	const size_t batchSize = batchSize_ ? batchSize_ : numSamples_;
+	const unsigned int threads = ParallelThreads(numThreads_, std::min(batchSize, numSamples_));
+	std::vector<ReaclibFitter> fitters(threads, settings_);
+	std::vector<std::vector<double> > realizations(threads, std::vector<double>(2 * n));
+
+	for (size_t first = 0; first < numSamples_; first += batchSize) {
+		const size_t count = std::min(batchSize, numSamples_ - first);
+		ParallelFor(count, threads, [&](const size_t i, const unsigned int thread) {
+			const size_t sample = first + i;
+			std::mt19937_64 generator(seed_ * 0x9E3779B97F4A7C15ULL + sample);
+			std::normal_distribution<double> normal;
+
+			//The realized rate followed by its uncertainty.
+			double *realized = realizations[thread].data(), *sigma = realized + n;
+			const double z = normal(generator);
+			for (size_t j = 0; j < n; j++) {
+				const double logFactor = log(factor[j]);
+				realized[j] = rate[j] * exp((correlated_ ? z : normal(generator)) * logFactor);
+				sigma[j] = realized[j] * logFactor;
+			}
+
+			ReaclibModel fit = model;
+			if (!fitters[thread].Fit(fit, t9, realized, sigma, n)) return;
+			std::copy(fit.GetParameters(), fit.GetParameters() + numPar,
+				parameters_.begin() + sample * numPar);
+			fit.EvaluateBatch(t9, rates_.data() + sample * n, n);
+			success_[sample] = true;
+		});
+		if (handler) {
+			ComputeBands(first + count);
+			handler(bands_);
+		}
+	}
+	if (!handler) ComputeBands(numSamples_);
+	return bands_.numSamples > 0;
+}
+
+/**Each parameter and each point of the rate is sorted over the successful
+ * samples and the percentiles are interpolated between the order statistics.
+ */
+void ReaclibMonteCarlo::ComputeBands(const size_t numDone) {
+	const unsigned int numPar = bands_.numParameters;
+	const size_t n = bands_.t9.size(), numPercentiles = bands_.percentiles.size();
+	bands_.numSamples = std::count(success_.begin(), success_.begin() + numDone, true);
+	bands_.numFailed = numDone - bands_.numSamples;
+	bands_.parameters.assign(numPercentiles * numPar, 0);
+	bands_.rate.assign(numPercentiles * n, 0);
+	if (!bands_.numSamples) return;
+
+	std::vector<double> column;
+	column.reserve(bands_.numSamples);
+	for (size_t c = 0; c < numPar + n; c++) {
+		column.clear();
+		for (size_t s = 0; s < numDone; s++) {
+			if (!success_[s]) continue;
+			column.push_back(c < numPar ? parameters_[s * numPar + c]
+				: rates_[s * n + c - numPar]);
+		}
+		std::sort(column.begin(), column.end());
+		for (size_t p = 0; p < numPercentiles; p++) {
+			const double value = Percentile(column, bands_.percentiles[p]);
+			if (c < numPar) bands_.parameters[p * numPar + c] = value;
+			else bands_.rate[p * n + c - numPar] = value;
+		}
+	}
+}
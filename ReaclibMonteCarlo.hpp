@@ -0,0 +1,126 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBMONTECARLO_H
+#define REACLIBMONTECARLO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+
+/**@brief Propagates the uncertainty of a tabulated rate to its REACLIB
+ *   parameters by refitting random realizations.
+ * @author Karl Smith
+ *
+ * Each sample draws a realization of the table from the lognormal
+ * distribution given by the factor uncertainty f.u. of every point,
+ * @f[
+ * 	r_i' = r_i\, f.u._i^{\,z}
+ * @f]
+ * with @f$ z @f$ a standard normal variate. By default one variate is drawn
+ * per sample, so the realization varies coherently with temperature as in
+ * STARLIB. Alternatively every point is drawn independently.
+ *
+ * The realizations are fit with ReaclibFitter starting from the given model,
+ * usually the fit of the table itself, so the fixed and free parameters of
+ * the ReaclibRate layout are respected. The samples run in batches over a
+ * pool of threads. After each batch the percentile bands of the parameters
+ * and of the fitted rate at the table temperatures are passed to a handler,
+ * so long runs can be monitored or stopped early:
+ * @code
+ * 	ReaclibMonteCarlo monteCarlo;
+ * 	monteCarlo.SetNumSamples(10000);
+ * 	monteCarlo.Run(rate->GetModel(), t9, lambda, factor, numPoints,
+ * 		[](const ReaclibMonteCarlo::Bands &bands) {
+ * 			printf("%zu samples\n", bands.numSamples);
+ * 		});
+ * @endcode
+ * Each sample is seeded from its index, so the bands do not depend on the
+ * number of threads or the batch size.
+ */
+class ReaclibMonteCarlo {
+	public:
+		/// @brief Percentile bands of the samples fit so far.
+		struct Bands {
+			/// The percentiles, between 0 and 1. Values outside are clamped.
+			std::vector<double> percentiles;
+			unsigned int numParameters; ///< The number of parameters of the model.
+			/// The parameter values at each percentile, numParameters per percentile.
+			std::vector<double> parameters;
+			std::vector<double> t9; ///< The table temperatures the rate is given at.
+			/// The fitted rate at each percentile, t9.size() values per percentile.
+			std::vector<double> rate;
+			size_t numSamples; ///< The number of samples fit successfully.
+			size_t numFailed; ///< The number of samples whose fit failed.
+		};
+
+		/// The function receiving the bands after each batch.
+		typedef std::function<void(const Bands&)> BandHandler;
+
+		/// @brief Default constructor.
+		ReaclibMonteCarlo();
+
+		/// @brief Sets the number of samples, 1000 by default.
+		void SetNumSamples(const size_t numSamples) {numSamples_ = numSamples;}
+
+		/// @brief Sets the number of samples between updates of the bands,
+		///   1024 by default, 0 to fit all samples in one batch.
+		void SetBatchSize(const size_t batchSize) {batchSize_ = batchSize;}
+
+		/// @brief Sets the number of threads, 0 by default for the number of
+		///   hardware threads.
+		void SetNumThreads(const unsigned int numThreads) {numThreads_ = numThreads;}
+
+		/// @brief Sets the seed of the realizations.
+		void SetSeed(const uint64_t seed) {seed_ = seed;}
+
+		/// @brief Sets whether one variate is drawn per sample, true by
+		///   default, or one per point.
+		void SetCorrelated(const bool correlated) {correlated_ = correlated;}
+
+		/// @brief Sets the percentiles of the bands, by default 0.025, 0.16,
+		///   0.5, 0.84 and 0.975.
+		void SetPercentiles(const std::vector<double> &percentiles) {
+			bands_.percentiles = percentiles;
+		}
+
+		/// @brief Returns the fitter settings applied to every sample.
+		ReaclibFitter& GetFitter() {return settings_;}
+
+		/// @brief Fits every sample.
+		/// @param[in] model The model giving the layout and starting parameters.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] factor Array of n factor uncertainties, each above one.
+		/// @param[in] n The number of points.
+		/// @param[in] handler The function called with the bands after each
+		///   batch, may be empty.
+		/// @return False if the table is invalid or no sample could be fit.
+		bool Run(const ReaclibModel &model, const double *t9, const double *rate,
+			const double *factor, const size_t n,
+			const BandHandler &handler = BandHandler());
+
+		/// @brief Returns the bands of the last run.
+		const Bands& GetBands() const {return bands_;}
+
+	private:
+		/// @brief Computes the bands from the samples fit so far.
+		void ComputeBands(const size_t numDone);
+
+		size_t numSamples_; ///< The number of samples.
+		size_t batchSize_; ///< The number of samples between updates.
+		unsigned int numThreads_; ///< The number of threads, 0 for all.
+		uint64_t seed_; ///< The seed of the realizations.
+		bool correlated_; ///< Whether one variate is drawn per sample.
+		ReaclibFitter settings_; ///< Holds the fitter settings.
+		Bands bands_; ///< The bands of the last run.
+		std::vector<double> parameters_; ///< The fitted parameters of each sample.
+		std::vector<double> rates_; ///< The fitted rate of each sample at the table temperatures.
+		std::vector<char> success_; ///< Whether each sample was fit.
+};
+
+#endif //REACLIBMONTECARLO_H
@@ -0,0 +1,105 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibMultiStart.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "ParallelFor.hpp"
+
+ReaclibMultiStart::ReaclibMultiStart() :
+	numStarts_(64),
+	numThreads_(0),
+	energySpread_(0.5),
+	a0Spread_(2),
+	seed_(0),
+	bestStart_(0)
+{
+
+}
+
+/**Each resonance energy is multiplied by a lognormal factor, which keeps its
+ * sign, and each a0 term is shifted uniformly. The generator is seeded from
+ * the seed and the start index only.
+ */
+void ReaclibMultiStart::Perturb(ReaclibModel &model,
+	const unsigned int start
+) const {
+	if (start == 0) return;
+	std::mt19937_64 generator(seed_ * 0x9E3779B97F4A7C15ULL + start);
+	std::normal_distribution<double> energyFactor(0, energySpread_);
+	std::uniform_real_distribution<double> a0Shift(-a0Spread_, a0Spread_);
+	for (unsigned int set = 0; set < model.GetNumSets(); set++) {
+		const unsigned int a0 = 7 * set, a1 = 7 * set + 1;
+		if (!model.IsFixed(a0)) {
+			model.SetParameter(a0, model.GetParameter(a0) + a0Shift(generator));
+		}
+		if (set > 0 && !model.IsFixed(a1)) {
+			model.SetParameter(a1, model.GetParameter(a1) * exp(energyFactor(generator)));
+		}
+	}
+}
+
+/**Every thread keeps the best of the starts it ran. Ties are broken by the
+ * lower start index, so the result is the same for any number of threads.
+ */
+bool ReaclibMultiStart::Fit(ReaclibModel &model, const double *t9,
+	const double *rate, const double *sigma, const size_t n,
+	ReaclibFitter::Result *result
+) {
+	const double kFailed = std::numeric_limits<double>::infinity();
+	startChi2_.assign(numStarts_, kFailed);
+
+	//The best fit found by a thread.
+	struct Best {
+		Best(const ReaclibModel &m) : model(m), start(0) {
+			result.chi2 = std::numeric_limits<double>::infinity();
+		}
+		ReaclibModel model;
+		unsigned int start;
+		ReaclibFitter::Result result;
+		std::vector<double> errors;
+	};
+
+	const unsigned int threads = ParallelThreads(numThreads_, numStarts_);
+	std::vector<ReaclibFitter> fitters(threads, settings_);
+	std::vector<Best> best(threads, Best(model));
+
+	ParallelFor(numStarts_, threads, [&](const size_t start, const unsigned int thread) {
+		ReaclibModel trial = model;
+		Perturb(trial, start);
+		ReaclibFitter::Result trialResult;
+		if (!fitters[thread].Fit(trial, t9, rate, sigma, n, &trialResult)) return;
+		if (!std::isfinite(trialResult.chi2)) return;
+		startChi2_[start] = trialResult.chi2;
+
+		Best &current = best[thread];
+		if (trialResult.chi2 < current.result.chi2 ||
+			(trialResult.chi2 == current.result.chi2 && start < current.start)) {
+			current.model = trial;
+			current.start = start;
+			current.result = trialResult;
+			current.errors = fitters[thread].GetErrors();
+		}
+	});
+
+	unsigned int bestThread = 0;
+	for (unsigned int t = 1; t < threads; t++) {
+		if (best[t].result.chi2 < best[bestThread].result.chi2 ||
+			(best[t].result.chi2 == best[bestThread].result.chi2 &&
+			 best[t].start < best[bestThread].start)) {
+			bestThread = t;
+		}
+	}
+	const Best &winner = best[bestThread];
+	if (!std::isfinite(winner.result.chi2)) return false;
+
+	model = winner.model;
+	bestStart_ = winner.start;
+	errors_ = winner.errors;
+	if (result) *result = winner.result;
+	return true;
+}
@@ -0,0 +1,114 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBMULTISTART_H
+#define REACLIBMULTISTART_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+
+/**@brief Fits a ReaclibModel from many perturbed starting points in parallel
+ *   and keeps the best fit.
+ * @author Karl Smith
+ *
+ * Fits with several resonances have many local minima, so the result of a
+ * single fit depends on the initial resonance energies. Each start perturbs
+ * the free resonance energies, the @f$ a_1 = -11.6045 E_r @f$ terms, by a
+ * random factor and shifts the free @f$ a_0 @f$ terms, then runs
+ * ReaclibFitter. The starts are spread over a pool of threads, each with its
+ * own fitter, and the start with the lowest chi-square is kept. The first
+ * start is the unperturbed model.
+ *
+ * Only free parameters are perturbed. To search over a resonance energy set
+ * with ReaclibModel::SetResonance it must be released first:
+ * @code
+ * 	model.SetResonance(0, 0.4, 1e-3);
+ * 	model.ReleaseParameter(7);
+ * 	model.ReleaseParameter(8);
+ * 	ReaclibMultiStart multiStart;
+ * 	multiStart.SetNumStarts(256);
+ * 	multiStart.Fit(model, t9, rate, sigma, numPoints);
+ * @endcode
+ * The starts are seeded from their index, so the result does not depend on
+ * the number of threads.
+ */
+class ReaclibMultiStart {
+	public:
+		/// @brief Default constructor.
+		ReaclibMultiStart();
+
+		/// @brief Sets the number of starts, 64 by default.
+		void SetNumStarts(const unsigned int numStarts) {numStarts_ = numStarts;}
+
+		/// @brief Returns the number of starts.
+		unsigned int GetNumStarts() const {return numStarts_;}
+
+		/// @brief Sets the number of threads, 0 by default for the number of
+		///   hardware threads.
+		void SetNumThreads(const unsigned int numThreads) {numThreads_ = numThreads;}
+
+		/// @brief Sets the spread of the resonance energies.
+		/// @param[in] spread The standard deviation of the logarithm of the
+		///   factor applied to each resonance energy, 0.5 by default.
+		void SetEnergySpread(const double spread) {energySpread_ = spread;}
+
+		/// @brief Sets the spread of the a0 terms.
+		/// @param[in] spread The half width of the uniform shift added to each
+		///   a0 term, 2 by default.
+		void SetA0Spread(const double spread) {a0Spread_ = spread;}
+
+		/// @brief Sets the seed of the perturbations.
+		void SetSeed(const uint64_t seed) {seed_ = seed;}
+
+		/// @brief Returns the fitter settings applied to every start.
+		/// @return A fitter whose iteration limit and tolerance are copied.
+		ReaclibFitter& GetFitter() {return settings_;}
+
+		/// @copydoc GetFitter()
+		const ReaclibFitter& GetFitter() const {return settings_;}
+
+		/// @brief Fits the model from every start.
+		/// @param[in,out] model The model, whose parameters are the centre of
+		///   the perturbations and are replaced by the best fit.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] sigma Array of n uncertainties of the rates, may be null.
+		/// @param[in] n The number of points.
+		/// @param[out] result The outcome of the best fit, may be null.
+		/// @return False if no start could be fit.
+		bool Fit(ReaclibModel &model, const double *t9, const double *rate,
+			const double *sigma, const size_t n,
+			ReaclibFitter::Result *result = 0);
+
+		/// @brief Returns the index of the best start of the last fit.
+		unsigned int GetBestStart() const {return bestStart_;}
+
+		/// @brief Returns the chi-square of each start of the last fit,
+		///   infinite if the start failed.
+		const std::vector<double>& GetStartChi2() const {return startChi2_;}
+
+		/// @brief Returns the parameter errors of the best fit.
+		const std::vector<double>& GetErrors() const {return errors_;}
+
+		/// @brief Perturbs the free parameters of a model as for a start.
+		/// @param[in,out] model The model to perturb.
+		/// @param[in] start The index of the start, 0 leaves the model as is.
+		void Perturb(ReaclibModel &model, const unsigned int start) const;
+
+	private:
+		unsigned int numStarts_; ///< The number of starts.
+		unsigned int numThreads_; ///< The number of threads, 0 for all.
+		double energySpread_; ///< The spread of the log of the resonance energies.
+		double a0Spread_; ///< The half width of the a0 shifts.
+		uint64_t seed_; ///< The seed of the perturbations.
+		ReaclibFitter settings_; ///< Holds the fitter settings.
+		unsigned int bestStart_; ///< The best start of the last fit.
+		std::vector<double> startChi2_; ///< The chi-square of each start.
+		std::vector<double> errors_; ///< The parameter errors of the best fit.
+};
+
+#endif //REACLIBMULTISTART_H
@@ -0,0 +1,248 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibParser.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+	///The powers of ten that are exactly representable as doubles.
+	const double kExactPowers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	///Column of the first nuclide in a set label line.
+	const unsigned int kNuclideColumn = 5;
+	///Width of each nuclide name.
+	const unsigned int kNuclideWidth = 5;
+	///Column of the four character label.
+	const unsigned int kLabelColumn = 43;
+	///Column of the resonance flag.
+	const unsigned int kResonanceColumn = 47;
+	///Column of the reverse flag.
+	const unsigned int kReverseColumn = 48;
+	///Column and width of the Q value.
+	const unsigned int kQColumn = 52, kQWidth = 12;
+	///Width of each coefficient.
+	const unsigned int kCoefficientWidth = 13;
+
+	/**Returns true if the line is blank.
+	 */
+	bool IsBlank(const char *line) {
+		for (; *line; line++) {
+			if (*line != ' ') return false;
+		}
+		return true;
+	}
+
+	/**Copies a fixed width field into a null terminated string without the 
+	 * surrounding spaces.
+	 */
+	void CopyField(const char *field, const unsigned int width, char *out) {
+		unsigned int begin = 0, end = width;
+		while (begin < end && field[begin] == ' ') begin++;
+		while (end > begin && field[end - 1] == ' ') end--;
+		memcpy(out, field + begin, end - begin);
+		out[end - begin] = '\0';
+	}
+}
+
+ReaclibParser::ReaclibParser() :
+	lineNumber_(0)
+{
+	line_[0] = '\0';
+}
+
+/**A chapter line holds a single integer and nothing else.
+ */
+unsigned int ReaclibParser::ParseChapter(const char *line) {
+	unsigned int chapter = 0;
+	bool digits = false;
+	for (; *line; line++) {
+		if (*line >= '0' && *line <= '9') {
+			if (digits && line[-1] == ' ') return 0;
+			chapter = 10 * chapter + (*line - '0');
+			digits = true;
+		}
+		else if (*line != ' ') return 0;
+	}
+	return chapter;
+}
+
+bool ReaclibParser::ParseSetLabel(const char *line, const unsigned int chapter,
+	ReactionInfo &info
+) {
+	memset(&info, 0, sizeof(info));
+	for (unsigned int i = 0; i < ReactionInfo::kMaxNuclides; i++) {
+		CopyField(line + kNuclideColumn + i * kNuclideWidth, kNuclideWidth, 
+			info.nuclides[i]);
+	}
+	CopyField(line + kLabelColumn, 4, info.label);
+	info.chapter = chapter;
+	info.reverse = line[kReverseColumn] == ' ' ? '\0' : line[kReverseColumn];
+	return ParseFixedFloat(line + kQColumn, kQWidth, info.qValue);
+}
+
+/**Handles the mantissa and exponent of Fortran style E and D formatted 
+ * numbers, including exponents written without the letter, e.g. 
+ * "1.234567-100". When the digits of the mantissa fit in 15 significant 
+ * figures and the power of ten is exactly representable the result is 
+ * correctly rounded with a single multiplication or division. Other values 
+ * are passed to strtod in normalized form.
+ */
+bool ReaclibParser::ParseFixedFloat(const char *field, const unsigned int width, 
+	double &value
+) {
+	const char *c = field, *end = field + width;
+	while (c < end && *c == ' ') c++;
+	const bool negative = c < end && *c == '-';
+	if (c < end && (*c == '-' || *c == '+')) c++;
+
+	uint64_t mantissa = 0;
+	int significant = 0, scale = 0;
+	bool anyDigits = false;
+	for (; c < end && *c >= '0' && *c <= '9'; c++, anyDigits = true) {
+		if (mantissa == 0 && *c == '0') continue;
+		if (significant < 19) {
+			mantissa = 10 * mantissa + (*c - '0');
+			significant++;
+		}
+		else scale++;
+	}
+	if (c < end && *c == '.') {
+		for (c++; c < end && *c >= '0' && *c <= '9'; c++, anyDigits = true) {
+			if (mantissa == 0 && *c == '0') {
+				scale--;
+				continue;
+			}
+			if (significant < 19) {
+				mantissa = 10 * mantissa + (*c - '0');
+				significant++;
+				scale--;
+			}
+		}
+	}
+	if (!anyDigits) return false;
+
+	if (c < end && (*c == 'e' || *c == 'E' || *c == 'd' || *c == 'D')) c++;
+	if (c < end && (*c == '-' || *c == '+' || (*c >= '0' && *c <= '9'))) {
+		const bool negativeExponent = *c == '-';
+		if (*c == '-' || *c == '+') c++;
+		int exponent = 0;
+		bool exponentDigits = false;
+		for (; c < end && *c >= '0' && *c <= '9'; c++, exponentDigits = true) {
+			if (exponent < 10000) exponent = 10 * exponent + (*c - '0');
+		}
+		if (!exponentDigits) return false;
+		scale += negativeExponent ? -exponent : exponent;
+	}
+	for (; c < end; c++) {
+		if (*c != ' ' && *c != '\0') return false;
+	}
+
+	if (significant <= 15 && scale >= -22 && scale <= 22) {
+		value = static_cast<double>(mantissa);
+		value = scale < 0 ? value / kExactPowers[-scale] : value * kExactPowers[scale];
+	}
+	else {
+		//Rare values are converted by the library from the normalized digits.
+		char buffer[48];
+		snprintf(buffer, sizeof(buffer), "%llue%d", 
+			static_cast<unsigned long long>(mantissa), scale);
+		value = strtod(buffer, 0);
+	}
+	if (negative) value = -value;
+	return true;
+}
+
+/**Reads a line with fgets, removes the line ending and pads the line with 
+ * spaces to kLineWidth so that trailing blank fields can be read.
+ */
+bool ReaclibParser::ReadLine(FILE *file) {
+	if (!fgets(line_, sizeof(line_), file)) return false;
+	lineNumber_++;
+	size_t length = strcspn(line_, "\r\n");
+	while (length < kLineWidth) line_[length++] = ' ';
+	line_[length] = '\0';
+	return true;
+}
+
+/**Chapter lines set the chapter of the following sets, blank lines are 
+ * skipped and any other line is taken as the label of a set whose 
+ * coefficients follow on the next two lines. A rate is passed to the handler
+ * once a set of a different reaction, or the end of the file, is reached.
+ */
+bool ReaclibParser::Parse(FILE *file, const EntryHandler &handler) {
+	lineNumber_ = 0;
+	entry_.numSets = 0;
+	unsigned int chapter = 0;
+	//The chapter, nuclides, label and reverse flag of the current rate.
+	char key[kReverseColumn + 2];
+
+	while (ReadLine(file)) {
+		if (IsBlank(line_)) continue;
+		const unsigned int lineChapter = ParseChapter(line_);
+		if (lineChapter) {
+			chapter = lineChapter;
+			continue;
+		}
+		if (!chapter) return false;
+
+		//Compare the identifying columns with the current rate.
+		char newKey[kReverseColumn + 2];
+		newKey[0] = static_cast<char>(chapter);
+		memcpy(newKey + 1, line_ + kNuclideColumn, kResonanceColumn - kNuclideColumn);
+		newKey[kResonanceColumn - kNuclideColumn + 1] = line_[kReverseColumn];
+		const size_t keyLength = kResonanceColumn - kNuclideColumn + 2;
+		if (entry_.numSets && memcmp(key, newKey, keyLength) != 0) {
+			handler(entry_);
+			entry_.numSets = 0;
+		}
+		if (entry_.numSets == kMaxSets) return false;
+
+		const unsigned int set = entry_.numSets;
+		if (set == 0) {
+			memcpy(key, newKey, keyLength);
+			if (!ParseSetLabel(line_, chapter, entry_.info)) return false;
+		}
+		entry_.resonanceFlags[set] = line_[kResonanceColumn];
+
+		//The coefficients a0 through a3 followed by a4 through a6.
+		double *a = entry_.par + 7 * set;
+		if (!ReadLine(file)) return false;
+		for (unsigned int j = 0; j < 4; j++) {
+			if (!ParseFixedFloat(line_ + j * kCoefficientWidth, kCoefficientWidth, a[j])) {
+				return false;
+			}
+		}
+		if (!ReadLine(file)) return false;
+		for (unsigned int j = 0; j < 3; j++) {
+			if (!ParseFixedFloat(line_ + j * kCoefficientWidth, kCoefficientWidth, a[4 + j])) {
+				return false;
+			}
+		}
+		entry_.setTypes[set] = ReaclibKernel::ClassifySet(a);
+		entry_.numSets++;
+	}
+	if (entry_.numSets) handler(entry_);
+	return true;
+}
+
+/**Every rate is added with the default REACLIB validity range of 
+ * 0.01 <= T9 <= 10 together with its reaction information.
+ */
+bool ReaclibParser::Load(const char *filename, RateLibrary &library) {
+	lineNumber_ = 0;
+	FILE *file = fopen(filename, "r");
+	if (!file) return false;
+	const bool success = Parse(file, [&library](const Entry &entry) {
+		library.AddRate(entry.par, entry.numSets, entry.setTypes, 0.01, 10, 
+			&entry.info, entry.resonanceFlags);
+	});
+	fclose(file);
+	return success;
+}
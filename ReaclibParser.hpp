@@ -0,0 +1,111 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBPARSER_H
+#define REACLIBPARSER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+
+#include "RateLibrary.hpp"
+#include "ReaclibKernel.hpp"
+
+/**@brief A streaming reader for the fixed width REACLIB database text format.
+ * @author Karl Smith
+ *
+ * Both the original format, where each chapter starts with a line holding 
+ * the chapter number followed by two blank lines, and the version 2 format,
+ * where the chapter number precedes every set, are accepted. Each set is a 
+ * label line followed by two lines with the seven coefficients. Consecutive 
+ * sets with the same chapter, nuclides, label and reverse flag form one rate.
+ *
+ * The file is read line by line into a fixed buffer and the fixed width 
+ * numbers are converted by hand, so no memory is allocated while parsing. 
+ * Each complete rate is handed to a callback, or appended directly to a 
+ * RateLibrary:
+ * @code
+ * 	RateLibrary library;
+ * 	ReaclibParser parser;
+ * 	if (!parser.Load("reaclib.txt", library)) {
+ * 		std::cerr << "Error on line " << parser.GetLineNumber() << "\n";
+ * 	}
+ * @endcode
+ * A rate can be loaded into a ReaclibRate with ReaclibRate::SetSets.
+ */
+class ReaclibParser {
+	public:
+		/// The maximum number of sets in a single rate, also the largest rate
+		/// ReaclibWriter writes.
+		static const unsigned int kMaxSets = 64;
+
+		/// @brief A complete rate read from the database.
+		struct Entry {
+			ReactionInfo info; ///< The reaction the rate describes.
+			unsigned int numSets; ///< The number of sets in the rate.
+			char resonanceFlags[kMaxSets]; ///< The REACLIB flag of each set, 'n', 'r', 'w' or 's'.
+			ReaclibKernel::SetType setTypes[kMaxSets]; ///< The structural type of each set.
+			double par[7 * kMaxSets]; ///< The REACLIB parameters of each set.
+		};
+
+		/// The function receiving each rate.
+		typedef std::function<void(const Entry&)> EntryHandler;
+
+		/// @brief Default constructor.
+		ReaclibParser();
+
+		/// @brief Reads every rate from an open file.
+		/// @param[in] file The file to read from.
+		/// @param[in] handler The function called with each rate.
+		/// @return True if the whole file was read, false on a malformed line.
+		bool Parse(FILE *file, const EntryHandler &handler);
+
+		/// @brief Reads every rate from a file into a library.
+		/// @param[in] filename The path to the REACLIB file.
+		/// @param[out] library The library the rates are appended to.
+		/// @return True if the whole file was read, false if it could not be 
+		///   opened or contained a malformed line.
+		bool Load(const char *filename, RateLibrary &library);
+
+		/// @brief Returns the last line read, i.e. the malformed line if 
+		///   parsing failed. Zero if the file could not be opened.
+		size_t GetLineNumber() const {return lineNumber_;}
+
+		/// @brief Parses a fixed width floating point field such as 
+		///   "-6.781610e+00".
+		/// @param[in] field The first character of the field.
+		/// @param[in] width The width of the field.
+		/// @param[out] value The parsed value.
+		/// @return False if the field is not a number.
+		static bool ParseFixedFloat(const char *field, const unsigned int width, 
+			double &value);
+
+		/// @brief Returns the chapter number of a line holding only a chapter.
+		/// @param[in] line The null terminated line.
+		/// @return The chapter, or zero if the line is not a chapter line.
+		static unsigned int ParseChapter(const char *line);
+
+		/// @brief Parses the nuclides, label, reverse flag and Q value of a set
+		///   label line.
+		/// @param[in] line The line, padded with spaces to kLineWidth.
+		/// @param[in] chapter The chapter the set belongs to.
+		/// @param[out] info The reaction information.
+		/// @return False if the Q value is not a number.
+		static bool ParseSetLabel(const char *line, const unsigned int chapter,
+			ReactionInfo &info);
+
+		/// The width lines are padded to before parsing.
+		static const unsigned int kLineWidth = 80;
+
+	private:
+
+		/// @brief Reads the next line into the buffer, padding it with spaces.
+		/// @return False at the end of the file.
+		bool ReadLine(FILE *file);
+
+		size_t lineNumber_; ///< The number of lines read.
+		char line_[256]; ///< The current line.
+		Entry entry_; ///< The rate being assembled.
+};
+
+#endif //REACLIBPARSER_H
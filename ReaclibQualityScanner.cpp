@@ -0,0 +1,79 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibQualityScanner.hpp"
+
+#include <cmath>
+
+ReaclibQualityScanner::ReaclibQualityScanner() :
+	numPoints_(100000),
+	x_(2 * kChunkSize),
+	exp_(2 * kChunkSize),
+	fit_(kChunkSize)
+{
+
+}
+
+/**The grid includes both ends of the table. For each chunk the logarithms of
+ * the grid temperatures and of the interpolated rates are computed by walking
+ * the table once, and both are exponentiated together with
+ * ReaclibKernel::Exp. A deviation that is not a number, e.g. from a fit that
+ * overflows, is reported as the largest deviation.
+ */
+bool ReaclibQualityScanner::Scan(const double *par,
+	const ReaclibKernel::SetType *setTypes, const unsigned int numSets,
+	const double *t9, const double *rate, const size_t n, Report &report
+) {
+	if (n < 2 || numPoints_ < 2) return false;
+	logRate_.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		if (!(rate[i] > 0) || (i > 0 && !(t9[i] > t9[i - 1]))) return false;
+		logRate_[i] = log(rate[i]);
+	}
+
+	const double logT9Min = log(t9[0]), logT9Max = log(t9[n - 1]);
+	const double step = (logT9Max - logT9Min) / (numPoints_ - 1);
+	//The logarithm of the lower temperature of the current table interval.
+	size_t interval = 0;
+	double logLow = logT9Min, logHigh = log(t9[1]);
+
+	double sumSquares = 0;
+	report.maxDeviation = -1;
+	for (size_t first = 0; first < numPoints_; first += kChunkSize) {
+		const size_t count = numPoints_ - first < kChunkSize ? numPoints_ - first : kChunkSize;
+
+		//Exponents of the grid temperatures followed by the table rates.
+		for (size_t i = 0; i < count; i++) {
+			const size_t point = first + i;
+			const double logT9 = point == numPoints_ - 1 ? logT9Max : logT9Min + point * step;
+			while (interval + 2 < n && logT9 > logHigh) {
+				interval++;
+				logLow = logHigh;
+				logHigh = log(t9[interval + 1]);
+			}
+			const double fraction = (logT9 - logLow) / (logHigh - logLow);
+			x_[i] = logT9;
+			x_[count + i] = logRate_[interval]
+				+ fraction * (logRate_[interval + 1] - logRate_[interval]);
+		}
+		ReaclibKernel::Exp(x_.data(), exp_.data(), 2 * count);
+		const double *gridT9 = exp_.data(), *tableRate = exp_.data() + count;
+		ReaclibKernel::EvaluateBatch(gridT9, fit_.data(), count, par, setTypes, 
+			numSets);
+
+		for (size_t i = 0; i < count; i++) {
+			const double deviation = fabs(fit_[i] - tableRate[i]) / tableRate[i];
+			sumSquares += deviation * deviation;
+			if (deviation > report.maxDeviation || deviation != deviation) {
+				report.maxDeviation = deviation;
+				report.worstT9 = gridT9[i];
+				report.worstTable = tableRate[i];
+				report.worstFit = fit_[i];
+			}
+		}
+	}
+	report.rmsDeviation = sqrt(sumSquares / numPoints_);
+	report.numPoints = numPoints_;
+	return true;
+}
@@ -0,0 +1,94 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBQUALITYSCANNER_H
+#define REACLIBQUALITYSCANNER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "ReaclibKernel.hpp"
+#include "ReaclibModel.hpp"
+
+/// @brief The deviation of a fit from its table found by 
+///   ReaclibQualityScanner, declared outside the class so it can be forward
+///   declared.
+struct ReaclibQualityReport {
+	double maxDeviation; ///< The largest relative deviation.
+	double rmsDeviation; ///< The root mean square relative deviation.
+	double worstT9; ///< The temperature of the largest deviation in GK.
+	double worstTable; ///< The interpolated table rate at worstT9.
+	double worstFit; ///< The fitted rate at worstT9.
+	size_t numPoints; ///< The number of grid points.
+};
+
+/**@brief Compares a fitted rate with its source table on a dense grid.
+ * @author Karl Smith
+ *
+ * The table is interpolated linearly in @f$ \ln T_9 @f$ and @f$ \ln r @f$,
+ * the usual interpolation of tabulated rates, onto a grid evenly spaced in
+ * @f$ \ln T_9 @f$ over the range of the table. The fitted rate is evaluated
+ * on the grid and the relative deviation
+ * @f$ |\lambda - r| / r @f$ is accumulated into its maximum and root mean
+ * square, together with the temperature of the worst point.
+ *
+ * The grid is processed in chunks: the temperatures and interpolated rates
+ * are computed with ReaclibKernel::Exp and the fit with
+ * ReaclibKernel::EvaluateBatch, so each chunk is a vectorized pass and no
+ * memory is allocated once the scanner has been used.
+ * @code
+ * 	ReaclibQualityScanner scanner;
+ * 	ReaclibQualityScanner::Report report;
+ * 	scanner.Scan(model, t9, rate, numPoints, report);
+ * 	printf("max %.3g at T9 = %.3g\n", report.maxDeviation, report.worstT9);
+ * @endcode
+ */
+class ReaclibQualityScanner {
+	public:
+		/// The deviation of a fit from its table.
+		typedef ReaclibQualityReport Report;
+
+		/// @brief Default constructor.
+		ReaclibQualityScanner();
+
+		/// @brief Sets the number of grid points, 100000 by default.
+		void SetNumPoints(const size_t numPoints) {numPoints_ = numPoints;}
+
+		/// @brief Compares a rate with a table.
+		/// @param[in] par The 7 * numSets REACLIB parameters.
+		/// @param[in] setTypes The structural type of each set.
+		/// @param[in] numSets The number of sets in the rate.
+		/// @param[in] t9 Array of n increasing temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] n The number of points in the table, at least 2.
+		/// @param[out] report The deviations.
+		/// @return False if the table has fewer than two points, temperatures
+		///   that do not increase or a rate that is not positive.
+		bool Scan(const double *par, const ReaclibKernel::SetType *setTypes,
+			const unsigned int numSets, const double *t9, const double *rate,
+			const size_t n, Report &report);
+
+		/// @brief Compares a model with a table.
+		/// @copydetails Scan(const double*, const ReaclibKernel::SetType*, const unsigned int, const double*, const double*, const size_t, Report&)
+		bool Scan(const ReaclibModel &model, const double *t9, const double *rate,
+			const size_t n, Report &report) {
+			return Scan(model.GetParameters(), model.GetSetTypes(),
+				model.GetNumSets(), t9, rate, n, report);
+		}
+
+	private:
+		/// The number of grid points processed together.
+		static const size_t kChunkSize = 4096;
+
+		/// Array aligned to a cache line.
+		typedef std::vector<double, AlignedAllocator<double> > Column;
+
+		size_t numPoints_; ///< The number of grid points.
+		Column logRate_; ///< The logarithm of each table rate.
+		Column x_; ///< The logarithms of the temperatures and table rates of a chunk.
+		Column exp_; ///< The temperatures and interpolated table rates of a chunk.
+		Column fit_; ///< The fitted rates of a chunk.
+};
+
+#endif //REACLIBQUALITYSCANNER_H
@@ -4,92 +4,77 @@
 
 #include "ReaclibRate.hpp"
 
+#ifdef REACLIB_COUNTERS
+#include <chrono>
+#include <cfloat>
+#endif
+
+#include "RateLibrary.hpp"
+#include "ReaclibFitter.hpp"
+#include "ReaclibMultiStart.hpp"
+#include "ReaclibQualityScanner.hpp"
+#include "ReaclibWriter.hpp"
+
 /** Constructor for charged particle reactions. Specifies the number of 
- *  resonances as well as the charge and reduced mass of the reactants.
- *
- *  For charged particle reactions the non-resonant set of parameters has a0 
- *  fixed based on S(0) (See ReaclibRate::SetSFactor). The a1 term is set based
- *  on the charge and mass of the reactants in the following form:
- *  \f[
- *    -4.2486 (Z_1^2 Z_2^2 \mu)^{1/3}
- *  \f]
- *  where \f$ Z_1 \f$ and \f$ Z_2 \f$ are the charge and \f$ \mu \f$ of the 
- *  reaction reactants.
- *  The a3 through a5 terms are allowed to float and the a6 term is set to -2/3.
- *
- *  For narrow resonances the a0 and a1 term are set based on the resonance 
- *  energy and strength (See ReaclibRate::SetResonance). The a2 through a5 
- *  terms are fixed to 0. Finally, a6 is set to -3/2.
- *
- *  \note Neutron induced non-resonant reaction rates are not yet supported.
+ *  resonances as well as the charge and reduced mass of the reactants. The 
+ *  initial parameters and the parameters that are fixed are taken from 
+ *  ReaclibModel.
  */
 ReaclibRate::ReaclibRate(
 	const char* name, const unsigned int numResonances, 
 	const unsigned int z1, const unsigned int z2, const float mu
 ) :
 	TF1(name, this, &ReaclibRate::Evaluate, 0.01, 10, 7 * (numResonances+1)), 
-	numResonances_(numResonances),
-	z1_(z1), 
-	z2_(z2), 
-	mu_amu_(mu) 
+	model_(numResonances, z1, z2, mu),
+	logMode_(false),
+	accuracy_(ReaclibKernel::kFull)
 {
-	//First set the non-resonant set of terms.
-	//Set a0 as we do not yet know S(0).
-	SetParameter(0, log(b_ * pow(z1_ * z2_ * mu_amu_, 1./3.)));
-	FixParameter(1, 0);
-	FixParameter(2, -4.2486 * pow(pow(z1_ * z2_, 2) * mu_amu_, 1./3.));
-	//Parameters a3 through a5 are allowed to vary.
-	FixParameter(6, -2./3.);
-
-	//Now we set all resonant set terms.
-	for (unsigned int i=0;i<numResonances_;i++) {
-		//Set a0 as we do not yet know the strength.
-		SetParameter(7 * (i+1) + 0, log(d_ * pow(mu_amu_, -3./2.)));
-		//Set a1 as we do not yet know the resonance energy.
-		SetParameter(7 * (i+1) + 1, -11.6045);
-		for (int j=2;j<=5;j++) {
-			FixParameter(7 * (i+1) + j, 0);
-		}
-		FixParameter(7 * (i+1) + 6, -3./2.);
+	CopyFromModel(0, model_.GetNumParameters());
+#ifdef REACLIB_COUNTERS
+	ResetCounters();
+#endif
+}
+
+#ifdef REACLIB_COUNTERS
+void ReaclibRate::ResetCounters() {
+	counters_.evaluateCalls = 0;
+	counters_.evaluateSeconds = 0;
+	counters_.fits = 0;
+	counters_.fitIterations = 0;
+	counters_.fitFunctionCalls = 0;
+	counters_.lastFitIterations = 0;
+	counters_.lastFitFunctionCalls = 0;
+	counters_.underflows.assign(model_.GetNumSets(), 0);
+	counters_.overflows.assign(model_.GetNumSets(), 0);
+	exponents_.resize(model_.GetNumSets());
+}
+#endif
+
+/**A parameter fixed in the model is fixed in the function, all others are 
+ * set and left free.
+ */
+void ReaclibRate::CopyFromModel(
+	const unsigned int first, const unsigned int count
+) {
+	for (unsigned int i=first; i<first+count; i++) {
+		if (model_.IsFixed(i)) FixParameter(i, model_.GetParameter(i));
+		else SetParameter(i, model_.GetParameter(i));
 	}
 }
 
-/** Sets the term (a0) of the non-resonant set associated with the s-factor at 
- *  energy zero, S(0). The a0 term takes the form 
- *  \f[
- *     ln[B (Z_1 Z_2 \mu)^{1/3} S(0)]
- *  \f] 
- *  where \f$ B = 7.8318 \times 10^9 cm^3 s^{-1} mole^{-1} MeV^{-1} \f$, 
- *  \f$ Z_1 \f$ and \f$ Z_2 \f$ are the charge of the reactants, \f$ \mu \f$ is
- *  the reduced mass of the reactants and \f$ S(0) \f$ is the value of the 
- *  S-factor evaluated at an energy of zero.
- *
- *  The parameter is fixed, but can be allowed to float by
- *  using the following: @code ReaclibRate::SetParLimits(0, 0, 0); @endcode
+/**Fixes the a0 term of the non-resonant set from S(0) (See 
+ * ReaclibModel::SetSFactor). The parameter can be allowed to float by
+ * using the following: @code ReaclibRate::SetParLimits(0, 0, 0); @endcode
  */
 void ReaclibRate::SetSFactor(float s0_MeVb) {
-	FixParameter(0, log(b_ * pow(z1_ * z2_ * mu_amu_, 1./3.) * s0_MeVb));
+	GetModel();
+	model_.SetSFactor(s0_MeVb);
+	CopyFromModel(0, 1);
 }
 
-/**Sets the terms for a resonance set. Specifically, a0 and a1 are set using 
- * the resonance strength and energy.
- *
- * For narrow resonances the a0 term takes on the following form:
- * \f[
- *   ln[D \mu^{-3/2} \omega\gamma]
- * \f]
- * where \f$ D = 1.5394 \times 10^{11} cm^3 s^{-1} mole^{-1} MeV^{-1} \f$,
- * \f$ \mu \f$ is the reactants reduced mass, and \f$ \omega \gamma \f$ is the
- * narrow resonance strength.
- *
- * The a1 term takes on the following form:
- * \f[
- *   -11.6045 E_r
- * \f]
- * where \f$ E_r \f$ is the resonance energy.
- *
- * The corresponding parameters are fixed, but can be allowed to float by
- * using the following: 
+/**Fixes the a0 and a1 terms of a resonance set from the resonance strength 
+ * and energy (See ReaclibModel::SetResonance). The corresponding parameters 
+ * can be allowed to float by using the following: 
  * @code 
  * 	ReaclibRate::SetParLimits(7 * (resonanceId + 1) + 0, 0, 0);
  * 	ReaclibRate::SetParLimits(7 * (resonanceId + 1) + 1, 0, 0); 
@@ -98,42 +83,154 @@ void ReaclibRate::SetSFactor(float s0_MeVb) {
 void ReaclibRate::SetResonance(
 	const unsigned int resonanceId, const float energy, const float strength
 ) {
-	if (resonanceId <= numResonances_) {
-		FixParameter(7 * (resonanceId+1) + 0, log(d_ * pow(mu_amu_, -3./2.) * strength));
-		FixParameter(7 * (resonanceId+1) + 1, -11.6045 * energy);
+	if (resonanceId < model_.GetNumResonances()) {
+		GetModel();
+		model_.SetResonance(resonanceId, energy, strength);
+		CopyFromModel(7 * (resonanceId+1), 2);
 	}
 }
 
-/**Extracts the reduced mass from the a2 term assuming that Z1 and Z2 are fixed.
- */
 double ReaclibRate::GetReducedMass() {
-	return pow(GetParameter(2) / -4.2486, 3.) / pow(z1_ * z2_, 2.);
+	return GetModel().GetReducedMass();
 }
 
-/**Extracts the S-factor term at zero energy, S(0), from the term a0 using the 
- * reduced mass determined from a2.
- */
 double ReaclibRate::GetSFactor() {
-	float mu_amu = GetReducedMass();
-	return exp(GetParameter(0)) / b_ / pow(z1_ * z2_ * mu_amu, 1./3.);
+	return GetModel().GetSFactor();
 }
 
-/**Extracts the resonance energy from the a1 term of the corresponding 
- * resonance set.
- */
 double ReaclibRate::GetResonanceEnergy(const unsigned int resonanceId) {
-	if (resonanceId > numResonances_) return -1;
-	return GetParameter(7*resonanceId + 1) / -11.6045;
+	return GetModel().GetResonanceEnergy(resonanceId);
 }
 
-/**Extracts the resonance strength from the a0 term of the corresponding 
- * resonance set using the reduced mass determined from the a2 term of the 
- * non-resonant set.
- */
 double ReaclibRate::GetResonanceStrength(const unsigned int resonanceId) {
-	if (resonanceId > numResonances_) return -1;
-	float mu_amu = GetReducedMass();
-	return exp(GetParameter(7*resonanceId + 0)) / d_ / pow(mu_amu, -3./2.);
+	return GetModel().GetResonanceStrength(resonanceId);
+}
+
+/**Parameters that are fixed keep their fixed status with the new value. 
+ * A rate read from the database can be loaded with:
+ * @code
+ * 	ReaclibRate rate("c12pg", entry.numSets - 1, 6, 1, 0.923);
+ * 	rate.SetSets(entry.par, entry.setTypes);
+ * @endcode
+ */
+void ReaclibRate::SetSets(
+	const double *par, const ReaclibKernel::SetType *setTypes
+) {
+	for (int i=0; i<GetNpar(); i++) {
+		if (IsParameterFixed(i)) FixParameter(i, par[i]);
+		else SetParameter(i, par[i]);
+	}
+	model_.SetSets(par, setTypes);
+}
+
+/**Sets the structural type of a set, which determines which terms are 
+ * evaluated. The types assigned by the constructor assume the fixed 
+ * parameters keep their values. If the a1 term of the non-resonant set or the 
+ * a2 through a6 terms of a resonance set are released and change during a 
+ * fit, the set is evaluated in full (See ReaclibKernel::ResolveSetType), so
+ * marking it as general is only an optimization:
+ * @code
+ * 	ReaclibRate::SetSetType(setId, ReaclibKernel::kGeneral);
+ * @endcode
+ */
+void ReaclibRate::SetSetType(
+	const unsigned int setId, const ReaclibKernel::SetType type
+) {
+	model_.SetSetType(setId, type);
+}
+
+ReaclibKernel::SetType ReaclibRate::GetSetType(const unsigned int setId) const {
+	return model_.GetSetType(setId);
+}
+
+/**As in the ROOT fitter a parameter is fixed if its limits are non-zero and
+ * the lower limit is not below the upper limit.
+ */
+bool ReaclibRate::IsParameterFixed(const int i) const {
+	double parMin, parMax;
+	GetParLimits(i, parMin, parMax);
+	return parMin * parMax != 0 && parMin >= parMax;
+}
+
+/**The parameters of the function are changed by TF1::Fit and the limits set 
+ * with TF1::SetParLimits, so the model is brought up to date before it is 
+ * returned.
+ */
+const ReaclibModel& ReaclibRate::GetModel() const {
+	for (int i=0; i<GetNpar(); i++) {
+		if (IsParameterFixed(i)) {
+			model_.FixParameter(i, GetParameter(i));
+		}
+		else {
+			model_.SetParameter(i, GetParameter(i));
+			model_.ReleaseParameter(i);
+		}
+	}
+	return model_;
+}
+
+/**Fits the rate in log space with the Levenberg-Marquardt fitter of 
+ * ReaclibFitter, which avoids the overhead of Minuit when many rates are 
+ * refit. The parameters, their errors, the chi-square and the degrees of 
+ * freedom of the function are updated as by TF1::Fit.
+ * @code
+ * 	rate->FitNative(t9, lambda, sigma, numPoints);
+ * @endcode
+ */
+bool ReaclibRate::FitNative(const double *t9, const double *rate, 
+	const double *sigma, const size_t n, ReaclibFitter::Result *result
+) {
+	ReaclibModel model = GetModel();
+	ReaclibFitter fitter;
+	ReaclibFitter::Result fitResult;
+	if (!fitter.Fit(model, t9, rate, sigma, n, &fitResult)) return false;
+	ApplyFit(model, fitter.GetErrors(), fitResult);
+	if (result) *result = fitResult;
+	return true;
+}
+
+/**Runs ReaclibMultiStart on the current model. The parameters of the best 
+ * start, their errors, the chi-square and the degrees of freedom of the 
+ * function are updated as by TF1::Fit. To search over the resonance energies
+ * their parameters must be free:
+ * @code
+ * 	rate->SetParLimits(8, 0, 0);
+ * 	ReaclibMultiStart multiStart;
+ * 	multiStart.SetNumStarts(512);
+ * 	rate->FitMultiStart(multiStart, t9, lambda, sigma, numPoints);
+ * @endcode
+ */
+bool ReaclibRate::FitMultiStart(ReaclibMultiStart &multiStart, 
+	const double *t9, const double *rate, const double *sigma, const size_t n,
+	ReaclibFitter::Result *result
+) {
+	ReaclibModel model = GetModel();
+	ReaclibFitter::Result fitResult;
+	if (!multiStart.Fit(model, t9, rate, sigma, n, &fitResult)) return false;
+	ApplyFit(model, multiStart.GetErrors(), fitResult);
+	if (result) *result = fitResult;
+	return true;
+}
+
+void ReaclibRate::ApplyFit(const ReaclibModel &model, 
+	const std::vector<double> &errors, const ReaclibFitter::Result &result
+) {
+	for (int i=0; i<GetNpar(); i++) {
+		if (!model.IsFixed(i)) SetParameter(i, model.GetParameter(i));
+		SetParError(i, errors[i]);
+	}
+	for (unsigned int set = 0; set < model.GetNumSets(); set++) {
+		model_.SetSetType(set, model.GetSetType(set));
+	}
+	SetChisquare(result.chi2);
+	SetNDF(result.ndf);
+#ifdef REACLIB_COUNTERS
+	counters_.fits++;
+	counters_.fitIterations += result.iterations;
+	counters_.fitFunctionCalls += result.functionCalls;
+	counters_.lastFitIterations = result.iterations;
+	counters_.lastFitFunctionCalls = result.functionCalls;
+#endif
 }
 
 /**Evaluates the reaction by summing each set. The zeroth set is the 
@@ -146,21 +243,164 @@ double ReaclibRate::GetResonanceStrength(const unsigned int resonanceId) {
  * @f]
  * where @f$ n @f$ is the set index. Typically a rate has one set for the 
  * non-resonant contribution and all subsequent sets are from narrow resonances.
+ *
+ * The temperature dependent terms are the same for every set, so they are 
+ * computed once and reused. Terms fixed to zero by the structural type of a
+ * set are skipped (See ReaclibKernel::Evaluate).
+ *
+ * If the log mode is enabled the logarithm of the rate is returned instead 
+ * (See ReaclibRate::SetLogMode).
+ *
+ * With REACLIB_COUNTERS defined the call is counted and timed, and the 
+ * exponent of each set is checked against the range of a double. The 
+ * exponents are reported by ReaclibKernel::EvaluateWithExponents, which 
+ * computes them once for both the value and the check, so the counted call 
+ * costs little more than the uncounted one and the check is included in the
+ * measured time. As TF1::Fit evaluates the function through this method, the
+ * counters also measure the cost of fits with Minuit:
+ * @code
+ * 	rate->ResetCounters();
+ * 	graph->Fit(rate);
+ * 	printf("%llu calls\n", (unsigned long long) rate->GetCounters().evaluateCalls);
+ * @endcode
  */
 double ReaclibRate::Evaluate(double *t9, double *par) {
-	//Value of the reaction rate at the specified t9 value.
-	double reacRate = 0;
-	//Loop over the resonances plus one for the non-resonant contribution.
-	for (unsigned int i=0; i< numResonances_ + 1; i++) {
-		//Compute the contribution from this component.
-		// We apply the exponential at the end of each set.
-		double component = par[7*i+0] + par[7*i+6] * log(t9[0]);
-		for (int j=1;j<=5;j++) {
-			component += par[7*i+j] * pow(t9[0],(2.*j-5.)/3.);
-		}
-		//Add the contribution to the total rate.
-		reacRate += exp(component);
+#ifdef REACLIB_COUNTERS
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const unsigned int numSets = model_.GetNumSets();
+	const double value = ReaclibKernel::EvaluateWithExponents(TemperatureBasis(t9[0]),
+		par, model_.GetSetTypes(), numSets, exponents_.data(), logMode_);
+
+	//The exponents beyond which exp is subnormal or infinite.
+	static const double kMinExponent = log(DBL_MIN), kMaxExponent = log(DBL_MAX);
+	for (unsigned int set = 0; set < numSets; set++) {
+		if (exponents_[set] < kMinExponent) counters_.underflows[set]++;
+		else if (exponents_[set] > kMaxExponent) counters_.overflows[set]++;
 	}
-	return reacRate;
+	counters_.evaluateCalls++;
+	counters_.evaluateSeconds += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+	return value;
+#else
+	if (logMode_) return EvaluateLog(t9, par);
+	return ReaclibKernel::Evaluate(t9[0], par, model_.GetSetTypes(), 
+		model_.GetNumSets());
+#endif
+}
+
+/**Evaluates the rate from temperature terms computed once by the caller, so
+ * that the cube root and logarithm are shared by every rate evaluated at the 
+ * same temperature. The linear rate is returned regardless of the log mode. 
+ * This is not an overload of ReaclibRate::Evaluate, which must stay unique 
+ * to be bound as the TF1 function.
+ */
+double ReaclibRate::EvaluateAt(const TemperatureBasis &basis) const {
+	return ReaclibKernel::Evaluate(basis, GetParameters(), model_.GetSetTypes(), 
+		model_.GetNumSets());
 }
 
+/**Evaluates the logarithm of the rate with a log-sum-exp over the sets (See 
+ * ReaclibKernel::EvaluateLog). Unlike the rate itself, the result does not 
+ * underflow at low temperatures. 
+ *
+ * With the log mode enabled the function can be fit to the logarithm of 
+ * tabulated rates, which spans far fewer decades than the rate and 
+ * converges in fewer iterations:
+ * @code
+ * 	rate->SetLogMode(true);
+ * 	logGraph->Fit(rate);
+ * @endcode
+ */
+double ReaclibRate::EvaluateLog(double *t9, double *par) {
+	return ReaclibKernel::EvaluateLog(t9[0], par, model_.GetSetTypes(), 
+		model_.GetNumSets());
+}
+
+/**Computes the rate and its derivative with respect to T9 in a single pass 
+ * over the sets (See ReaclibKernel::EvaluateWithDerivative). The logarithmic
+ * derivative follows as @f$ d\ln\lambda / d\ln T_9 = T_9 \lambda' / \lambda @f$.
+ * The linear rate is returned regardless of the log mode.
+ */
+void ReaclibRate::EvaluateWithDerivative(
+	const double t9, double *rate, double *dRate_dT9
+) {
+	*rate = ReaclibKernel::EvaluateWithDerivative(t9, GetParameters(), 
+		model_.GetSetTypes(), model_.GetNumSets(), dRate_dT9);
+}
+
+/**As ReaclibRate::EvaluateWithDerivative(const double, double*, double*) with
+ * the temperature terms computed once by the caller.
+ */
+void ReaclibRate::EvaluateWithDerivative(
+	const TemperatureBasis &basis, double *rate, double *dRate_dT9
+) const {
+	*rate = ReaclibKernel::EvaluateWithDerivative(basis, GetParameters(), 
+		model_.GetSetTypes(), model_.GetNumSets(), dRate_dT9);
+}
+
+/**Computes the derivatives analytically rather than with the finite 
+ * differences of TF1 (See ReaclibKernel::EvaluateGradient). If the log mode 
+ * is enabled the derivatives of the logarithm of the rate are returned. The 
+ * gradient is used by the fitter when the "G" option is given:
+ * @code
+ * 	graph->Fit(rate, "G");
+ * @endcode
+ */
+void ReaclibRate::GradientPar(const Double_t *x, Double_t *grad, Double_t) {
+	ReaclibKernel::EvaluateGradient(x[0], GetParameters(), model_.GetSetTypes(), 
+		model_.GetNumSets(), grad, logMode_);
+}
+
+/**Computes the full analytic gradient and returns the requested component.
+ */
+Double_t ReaclibRate::GradientPar(Int_t ipar, const Double_t *x, Double_t) {
+	if (ipar < 0 || ipar >= GetNpar()) return 0;
+	std::vector<double> grad(GetNpar());
+	GradientPar(x, grad.data());
+	return grad[ipar];
+}
+
+/**Evaluates the rate for each of the n temperatures in t9 using the current
+ * parameters of the function. The parameter block is fetched once and the 
+ * temperatures are handed to the vectorized ReaclibKernel::EvaluateBatch, 
+ * avoiding the per point overhead of going through TF1::Eval. The exponential
+ * is computed at the accuracy set with ReaclibRate::SetAccuracy. The single 
+ * point ReaclibRate::Evaluate always uses the math library, as it is the 
+ * function minimized by TF1::Fit.
+ */
+void ReaclibRate::EvaluateBatch(const double *t9, double *out, const size_t n) {
+	ReaclibKernel::EvaluateBatch(t9, out, n, GetParameters(), model_.GetSetTypes(), 
+		model_.GetNumSets(), accuracy_);
+}
+
+/**Evaluates the current parameters directly with the vectorized kernels 
+ * rather than looping over TF1::Eval:
+ * @code
+ * 	ReaclibQualityScanner scanner;
+ * 	ReaclibQualityScanner::Report report;
+ * 	rate->ScanQuality(scanner, t9, lambda, numPoints, report);
+ * @endcode
+ */
+bool ReaclibRate::ScanQuality(ReaclibQualityScanner &scanner, 
+	const double *t9, const double *rate, const size_t n, 
+	ReaclibQualityScanner::Report &report
+) const {
+	return scanner.Scan(GetParameters(), model_.GetSetTypes(), 
+		model_.GetNumSets(), t9, rate, n, report);
+}
+
+size_t ReaclibRate::AddToLibrary(RateLibrary &library, 
+	const ReactionInfo *info
+) const {
+	double t9Min, t9Max;
+	GetRange(t9Min, t9Max);
+	return library.AddRate(GetParameters(), model_.GetNumSets(), 
+		model_.GetSetTypes(), t9Min, t9Max, info);
+}
+
+bool ReaclibRate::WriteReaclib(ReaclibWriter &writer, 
+	const ReactionInfo &info
+) const {
+	return writer.WriteRate(info, GetParameters(), model_.GetNumSets(), 
+		model_.GetSetTypes());
+}
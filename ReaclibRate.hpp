@@ -4,8 +4,27 @@
 #ifndef REACLIBRATE_H
 #define REACLIBRATE_H
 
+#include <cstddef>
+#include <vector>
+
+#ifdef REACLIB_COUNTERS
+#include <cstdint>
+#endif
+
 #include "TF1.h"
 
+#include "ReaclibKernel.hpp"
+#include "ReaclibModel.hpp"
+#include "TemperatureBasis.hpp"
+
+class RateLibrary;
+class ReaclibMultiStart;
+class ReaclibQualityScanner;
+class ReaclibWriter;
+struct ReaclibFitResult;
+struct ReaclibQualityReport;
+struct ReactionInfo;
+
 /**@brief A class inheriting from a TF1 that assists in the fitting of a 
  *   reaction rate to the JINA REACLIB format.
  * @author Karl Smith
@@ -17,9 +36,52 @@
  * charges, reduced mass, S(0), number of resonances, resonance energies, 
  * and resonance strengths) and make educated guess about initial values. After 
  * the fit is performed the resulting physical parameters can be extracted.
+ *
+ * The physics is implemented by ReaclibModel, which does not depend on ROOT.
+ * This class exposes the model as a TF1 for fitting and the fitted model can
+ * be retrieved with ReaclibRate::GetModel. This header only includes the 
+ * model; the classes taken by the fitting, scanning and export methods are
+ * declared in their own headers, which callers of those methods include.
+ *
+ * If the library is compiled with REACLIB_COUNTERS defined, the rate counts
+ * its evaluations and fits (See ReaclibRate::Counters). Without it the 
+ * counters and their accessors do not exist and cost nothing. The macro 
+ * changes the layout of the class, so it must be defined for every 
+ * translation unit.
  */
 class ReaclibRate : public TF1 {
 	public:
+#ifdef REACLIB_COUNTERS
+		/// @brief Instrumentation of the evaluations and fits of a rate.
+		struct Counters {
+			uint64_t evaluateCalls; ///< The number of calls to Evaluate.
+			double evaluateSeconds; ///< The total time spent in Evaluate.
+			/// The number of fits with FitNative or FitMultiStart. Fits with 
+			/// TF1::Fit are not counted here, as Minuit does not report its 
+			/// iterations to the function; their cost shows in evaluateCalls 
+			/// and evaluateSeconds.
+			uint64_t fits;
+			uint64_t fitIterations; ///< The total iterations of the counted fits.
+			uint64_t fitFunctionCalls; ///< The total model evaluations of the counted fits.
+			unsigned int lastFitIterations; ///< The iterations of the last counted fit.
+			size_t lastFitFunctionCalls; ///< The model evaluations of the last counted fit.
+			/// The number of Evaluate calls for which the exponent of each set 
+			/// was below the smallest normal double, i.e. its contribution 
+			/// underflowed.
+			std::vector<uint64_t> underflows;
+			/// The number of Evaluate calls for which the exponent of each set 
+			/// overflowed.
+			std::vector<uint64_t> overflows;
+		};
+
+		/// @brief Returns the counters accumulated since construction or the
+		///   last call to ResetCounters.
+		const Counters& GetCounters() const {return counters_;}
+
+		/// @brief Sets every counter to zero.
+		void ResetCounters();
+#endif
+
 		/// @brief Charged particle constructor.
 		/// @param[in] name The name given to the rate.
 		/// @param[in] numResonances The number of sets of resonance to add in 
@@ -51,6 +113,80 @@ class ReaclibRate : public TF1 {
 		/// @return The reaction rate for the specified t9 value and parameters.
 		double Evaluate(double *t9, double *par);
 
+		/// @brief Evaluates the rate with the current parameters from a 
+		///   precomputed temperature basis.
+		/// @param[in] basis The temperature terms.
+		/// @return The reaction rate.
+		double EvaluateAt(const TemperatureBasis &basis) const;
+
+		/// @brief Evaluates the natural logarithm of the rate at the given 
+		///   temperature and parameters.
+		/// @param[in] t9 Pointer to T9 values.
+		/// @param[in] par Pointer to function parameters.
+		/// @return The logarithm of the reaction rate.
+		double EvaluateLog(double *t9, double *par);
+
+		/// @brief Evaluates the rate and its temperature derivative with the 
+		///   current parameters.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[out] rate The reaction rate.
+		/// @param[out] dRate_dT9 The derivative of the rate with respect to T9.
+		void EvaluateWithDerivative(const double t9, double *rate, 
+			double *dRate_dT9);
+
+		/// @brief Evaluates the rate and its temperature derivative with the 
+		///   current parameters from a precomputed temperature basis.
+		/// @param[in] basis The temperature terms.
+		/// @param[out] rate The reaction rate.
+		/// @param[out] dRate_dT9 The derivative of the rate with respect to T9.
+		void EvaluateWithDerivative(const TemperatureBasis &basis, double *rate, 
+			double *dRate_dT9) const;
+
+		using TF1::GradientPar;
+
+		/// @brief Returns the derivative of the function with respect to a 
+		///   parameter at the current parameter values.
+		/// @param[in] ipar The index of the parameter.
+		/// @param[in] x Pointer to T9 values.
+		/// @param[in] eps Unused, the derivative is computed analytically.
+		/// @return The derivative with respect to the parameter.
+		virtual Double_t GradientPar(Int_t ipar, const Double_t *x, 
+			Double_t eps = 0.01);
+
+		/// @brief Computes the derivatives of the function with respect to all 
+		///   parameters at the current parameter values.
+		/// @param[in] x Pointer to T9 values.
+		/// @param[out] grad Array of GetNpar() derivatives.
+		/// @param[in] eps Unused, the derivatives are computed analytically.
+		virtual void GradientPar(const Double_t *x, Double_t *grad, 
+			Double_t eps = 0.01);
+
+		/// @brief Sets whether the function returns the logarithm of the rate.
+		/// @param[in] logMode If true the function evaluates ln(rate).
+		void SetLogMode(const bool logMode) {logMode_ = logMode;}
+
+		/// @brief Returns true if the function returns the logarithm of the 
+		///   rate.
+		bool GetLogMode() const {return logMode_;}
+
+		/// @brief Sets the accuracy of the exponential used by EvaluateBatch,
+		///   ReaclibKernel::kFull by default. The single point Evaluate, used
+		///   by TF1 and by networks, always calls std::exp.
+		/// @param[in] accuracy The accuracy tier.
+		void SetAccuracy(const ReaclibKernel::Accuracy accuracy) {
+			accuracy_ = accuracy;
+		}
+
+		/// @brief Returns the accuracy of the exponential used by EvaluateBatch.
+		ReaclibKernel::Accuracy GetAccuracy() const {return accuracy_;}
+
+		/// @brief Evaluates the rate at many temperatures with the current 
+		///   parameters. The linear rate is returned regardless of the log mode.
+		/// @param[in] t9 Array of n T9 values.
+		/// @param[out] out Array of n values filled with the reaction rate.
+		/// @param[in] n The number of temperatures to evaluate.
+		void EvaluateBatch(const double *t9, double *out, const size_t n);
+
 		/// @brief Returns the S-factor, S(0), determined from the fit parameters.
 		/// @return The S-factor in MeV-b.
 		double GetSFactor();
@@ -71,15 +207,106 @@ class ReaclibRate : public TF1 {
 		///   returned.
 		double GetResonanceStrength(const unsigned int resosanceId);
 
+		/// @brief Replaces the parameters and structural types of all sets, 
+		///   e.g. with a rate read by ReaclibParser.
+		/// @param[in] par The 7 * (numResonances + 1) parameters.
+		/// @param[in] setTypes The structural type of each set.
+		void SetSets(const double *par, const ReaclibKernel::SetType *setTypes);
+
+		/// @brief Sets the structural type of a set.
+		/// @param[in] setId The ID of the set, 0 is the non-resonant set.
+		/// @param[in] type The structural type of the set.
+		void SetSetType(const unsigned int setId, 
+			const ReaclibKernel::SetType type
+		);
+
+		/// @brief Returns the structural type of a set.
+		/// @param[in] setId The ID of the set, 0 is the non-resonant set.
+		/// @return The structural type. If the set ID is invalid 
+		///   ReaclibKernel::kGeneral is returned.
+		ReaclibKernel::SetType GetSetType(const unsigned int setId) const;
+
+		/// @brief Returns the model with the current parameters of the function
+		///   and their fixed status.
+		const ReaclibModel& GetModel() const;
+
+		/// @brief Fits the free parameters to a tabulated rate with 
+		///   ReaclibFitter instead of TF1::Fit.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] sigma Array of n uncertainties of the rates, may be null.
+		/// @param[in] n The number of points.
+		/// @param[out] result The outcome of the fit, may be null.
+		/// @return False if the data can not be fit.
+		bool FitNative(const double *t9, const double *rate, const double *sigma,
+			const size_t n, ReaclibFitResult *result = 0);
+
+		/// @brief Fits the free parameters to a tabulated rate from many 
+		///   perturbed starts in parallel, keeping the best fit.
+		/// @param[in] multiStart The multi-start fitter and its settings.
+		/// @param[in] t9 Array of n temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] sigma Array of n uncertainties of the rates, may be null.
+		/// @param[in] n The number of points.
+		/// @param[out] result The outcome of the best fit, may be null.
+		/// @return False if no start could be fit.
+		bool FitMultiStart(ReaclibMultiStart &multiStart, const double *t9, 
+			const double *rate, const double *sigma, const size_t n, 
+			ReaclibFitResult *result = 0);
+
+		/// @brief Compares the rate with its source table on a dense grid (See
+		///   ReaclibQualityScanner).
+		/// @param[in] scanner The scanner and its settings.
+		/// @param[in] t9 Array of n increasing temperatures in GK.
+		/// @param[in] rate Array of n positive rates.
+		/// @param[in] n The number of points in the table.
+		/// @param[out] report The deviations.
+		/// @return False if the table is invalid.
+		bool ScanQuality(ReaclibQualityScanner &scanner, const double *t9, 
+			const double *rate, const size_t n, 
+			ReaclibQualityReport &report) const;
+
+		/// @brief Adds the fitted rate to a library. The range of the function 
+		///   is used as the validity range of the rate.
+		/// @param[in] library The library receiving the rate.
+		/// @param[in] info The reaction the rate describes, may be null.
+		/// @return The index of the rate in the library.
+		size_t AddToLibrary(RateLibrary &library, 
+			const ReactionInfo *info = 0) const;
+
+		/// @brief Writes the fitted rate in the REACLIB format.
+		/// @param[in] writer The open writer.
+		/// @param[in] info The reaction the rate describes.
+		/// @return False if the write failed.
+		bool WriteReaclib(ReaclibWriter &writer, const ReactionInfo &info) const;
+
 	private:
-		const unsigned int numResonances_; ///< The number of resonance sets for this rate.
-		const unsigned int z1_; ///< Atomic number of the target.
-		const unsigned int z2_; ///< Atomic number of the reactant.
-		const float mu_amu_; ///< Reduced mass of the reactants in amu.
-		///Constant used for non-resonant a0 term. In units of @f$ cm^3 s^{-1} mole^{-1} MeV^{-1} barn^{-1} @f$
-		static constexpr float b_ = 7.8318E9; 
-		///Constant used for resonant a0 term. In units of @f$ cm^3 s^{-1} mole^{-1} MeV^{-1} @f$
-		static constexpr float d_ = 1.5394E11;
+		/// @brief Returns true if a parameter of the function is fixed by its
+		///   limits.
+		/// @param[in] i The index of the parameter.
+		bool IsParameterFixed(const int i) const;
+
+		/// @brief Copies parameters and their fixed status from the model to the
+		///   function.
+		/// @param[in] first The index of the first parameter to copy.
+		/// @param[in] count The number of parameters to copy.
+		void CopyFromModel(const unsigned int first, const unsigned int count);
+
+		/// @brief Copies the fitted free parameters, the set types and the fit 
+		///   statistics to the function.
+		/// @param[in] model The fitted model.
+		/// @param[in] errors The error of each parameter.
+		/// @param[in] result The outcome of the fit.
+		void ApplyFit(const ReaclibModel &model, const std::vector<double> &errors,
+			const ReaclibFitResult &result);
+
+		mutable ReaclibModel model_; ///< The model, synchronized on access by GetModel.
+		bool logMode_; ///< Whether the function returns the logarithm of the rate.
+		ReaclibKernel::Accuracy accuracy_; ///< The accuracy of EvaluateBatch.
+#ifdef REACLIB_COUNTERS
+		Counters counters_; ///< The instrumentation counters.
+		std::vector<double> exponents_; ///< The exponent of each set in the last Evaluate.
+#endif
 };
 
 #endif //REACLIBRATE_H
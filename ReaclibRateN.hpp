@@ -0,0 +1,148 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBRATEN_H
+#define REACLIBRATEN_H
+
+#include <cmath>
+#include <cstddef>
+
+#include "ReaclibKernel.hpp"
+#include "TemperatureBasis.hpp"
+
+/**@brief A fixed size REACLIB rate with the number of resonances known at 
+ *   compile time.
+ * @author Karl Smith
+ *
+ * The parameters follow the layout of ReaclibRate: set 0 is the non-resonant
+ * set and sets 1 through NRes are narrow resonances with a2 through a5 equal 
+ * to zero and a6 equal to -3/2. The parameters are stored in a fixed size, 
+ * cache line aligned array and the loop over sets is unrolled at compile 
+ * time, so evaluation can be inlined into the caller. This is intended for 
+ * networks using a fixed catalogue of fitted rates, for example:
+ * @code
+ * 	ReaclibRateN<2> rate(fittedRate.GetParameters());
+ * 	double lambda = rate.Evaluate(t9);
+ * @endcode
+ * If a term skipped by the layout, the non-resonant a1 or the resonance a2
+ * through a6, differs from the value it implies, the unrolled sum is not used
+ * and the rate is evaluated by ReaclibKernel::Evaluate in the general form.
+ */
+template <unsigned int NRes>
+class ReaclibRateN {
+	public:
+		/// The number of sets, including the non-resonant set.
+		static const unsigned int kNumSets = NRes + 1;
+		/// The number of REACLIB parameters.
+		static const unsigned int kNumParameters = 7 * kNumSets;
+
+		/// @brief Constructor.
+		/// @param[in] par The kNumParameters REACLIB parameters.
+		explicit ReaclibRateN(const double *par) {
+			setTypes_[0] = ReaclibKernel::kNonResonant;
+			for (unsigned int i = 1; i < kNumSets; i++) {
+				setTypes_[i] = ReaclibKernel::kNarrowResonance;
+			}
+			SetParameters(par);
+		}
+
+		/// @brief Replaces the REACLIB parameters.
+		/// @param[in] par The kNumParameters REACLIB parameters.
+		void SetParameters(const double *par) {
+			structural_ = true;
+			for (unsigned int i = 0; i < kNumParameters; i++) par_[i] = par[i];
+			for (unsigned int i = 0; i < kNumSets; i++) {
+				if (ReaclibKernel::ResolveSetType(par_ + 7 * i, setTypes_[i]) != setTypes_[i]) {
+					structural_ = false;
+				}
+			}
+		}
+
+		/// @brief Returns the specified parameter.
+		/// @param[in] i The parameter index, 7 * set + term.
+		/// @return The parameter value.
+		double GetParameter(const unsigned int i) const {return par_[i];}
+
+		/// @brief Returns a pointer to the kNumParameters parameters.
+		const double* GetParameters() const {return par_;}
+
+		/// @brief Evaluates the rate at a single temperature.
+		/// @param[in] basis The temperature terms.
+		/// @return The reaction rate.
+		double Evaluate(const TemperatureBasis &basis) const;
+
+		/// @brief Evaluates the rate at a single temperature.
+		/// @param[in] t9 The temperature in GK.
+		/// @return The reaction rate.
+		double Evaluate(const double t9) const {
+			return Evaluate(TemperatureBasis(t9));
+		}
+
+		/// @brief Evaluates the rate and its temperature derivative.
+		/// @param[in] basis The temperature terms.
+		/// @param[out] dRate_dT9 The derivative of the rate with respect to T9.
+		/// @return The reaction rate.
+		double EvaluateWithDerivative(const TemperatureBasis &basis, 
+			double *dRate_dT9
+		) const {
+			return ReaclibKernel::EvaluateWithDerivative(basis, par_, setTypes_, 
+				kNumSets, dRate_dT9);
+		}
+
+		/// @brief Evaluates the rate and its temperature derivative.
+		/// @param[in] t9 The temperature in GK.
+		/// @param[out] dRate_dT9 The derivative of the rate with respect to T9.
+		/// @return The reaction rate.
+		double EvaluateWithDerivative(const double t9, double *dRate_dT9) const {
+			return EvaluateWithDerivative(TemperatureBasis(t9), dRate_dT9);
+		}
+
+		/// @brief Evaluates the rate at many temperatures.
+		/// @param[in] t9 Array of n T9 values.
+		/// @param[out] out Array of n values filled with the reaction rate.
+		/// @param[in] n The number of temperatures to evaluate.
+		void EvaluateBatch(const double *t9, double *out, const size_t n) const {
+			ReaclibKernel::EvaluateBatch(t9, out, n, par_, setTypes_, kNumSets);
+		}
+
+	private:
+		/// @brief Sums exp(a0 + a1 / T9) over resonance sets 1 through Count.
+		template <unsigned int Count, bool Dummy = true>
+		struct ResonanceSum {
+			static double Sum(const double *par, const double t9Inv) {
+				return ResonanceSum<Count - 1>::Sum(par, t9Inv)
+					+ exp(par[7 * Count] + par[7 * Count + 1] * t9Inv);
+			}
+		};
+
+		/// @brief Terminates the unrolled sum over resonance sets.
+		template <bool Dummy>
+		struct ResonanceSum<0, Dummy> {
+			static double Sum(const double *, const double) {return 0;}
+		};
+
+		alignas(64) double par_[kNumParameters]; ///< The REACLIB parameters.
+		ReaclibKernel::SetType setTypes_[kNumSets]; ///< The type of each set.
+		bool structural_; ///< True if every set holds the terms its type implies.
+};
+
+/**Evaluates the non-resonant set with all but the fixed a1 term, followed by
+ * the unrolled sum of the resonances scaled by the shared @f$ T_9^{-3/2} @f$ 
+ * factor, matching ReaclibKernel::Evaluate. Rates with a released skipped
+ * term are passed to ReaclibKernel::Evaluate.
+ */
+template <unsigned int NRes>
+inline double ReaclibRateN<NRes>::Evaluate(const TemperatureBasis &basis) const {
+	if (!structural_) return ReaclibKernel::Evaluate(basis, par_, setTypes_, kNumSets);
+	typedef TemperatureBasis B;
+	double reacRate = exp(par_[0] + par_[2] * basis[B::kInverseThird] 
+		+ par_[3] * basis[B::kThird] + par_[4] * basis[B::kLinear] 
+		+ par_[5] * basis[B::kFiveThirds] + par_[6] * basis[B::kLog]);
+	if (NRes > 0) {
+		reacRate += ResonanceSum<NRes>::Sum(par_, basis[B::kInverse]) 
+			* basis.GetT9InvThreeHalves();
+	}
+	return reacRate;
+}
+
+#endif //REACLIBRATEN_H
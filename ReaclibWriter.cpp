@@ -0,0 +1,139 @@
+/** @file
+ *  @author Karl Smith
+ */
+
+#include "ReaclibWriter.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ReaclibParser.hpp"
+
+ReaclibWriter::ReaclibWriter() :
+	file_(0),
+	success_(true)
+{
+
+}
+
+ReaclibWriter::~ReaclibWriter() {
+	Close();
+}
+
+bool ReaclibWriter::Open(const char *filename, const bool append) {
+	Close();
+	file_ = fopen(filename, append ? "a" : "w");
+	success_ = file_ != 0;
+	return success_;
+}
+
+bool ReaclibWriter::Close() {
+	if (file_ && fclose(file_) != 0) success_ = false;
+	file_ = 0;
+	return success_;
+}
+
+/**Numbers are written in exponential notation. Exponents with three digits 
+ * are written in the Fortran style without the letter, e.g. "1.234567-100", 
+ * so that the field keeps its width.
+ */
+void ReaclibWriter::FormatFixedFloat(const double value, const int digits, 
+	const int width, char *out
+) {
+	char buffer[64];
+	int length = snprintf(buffer, sizeof(buffer), "%.*e", digits, value);
+	char *exponent = strchr(buffer, 'e');
+	if (exponent && length > width && abs(atoi(exponent + 1)) >= 100) {
+		memmove(exponent, exponent + 1, strlen(exponent));
+		length--;
+	}
+	const int padding = width > length ? width - length : 0;
+	memset(out, ' ', padding);
+	memcpy(out + padding, buffer, length + 1);
+}
+
+/**The given resonance flags are written unchanged. Without them narrow 
+ * resonance sets are flagged 'r' and all other sets 'n'. Consecutive sets
+ * with the same reaction are read back as one rate, so a rate with more sets
+ * than ReaclibParser accepts can not be split and is rejected.
+ */
+bool ReaclibWriter::WriteRate(const ReactionInfo &info, const double *par, 
+	const unsigned int numSets, const ReaclibKernel::SetType *setTypes,
+	const char *resonanceFlags
+) {
+	if (!file_) return false;
+	if (numSets > ReaclibParser::kMaxSets) {
+		success_ = false;
+		return false;
+	}
+	char label[5];
+	snprintf(label, sizeof(label), "%-4s", info.label);
+	char qValue[32];
+	FormatFixedFloat(info.qValue, 5, 12, qValue);
+
+	for (unsigned int i = 0; i < numSets && success_; i++) {
+		char line[256];
+		int length = snprintf(line, sizeof(line), "%u\n     ", info.chapter);
+		for (unsigned int j = 0; j < ReactionInfo::kMaxNuclides; j++) {
+			length += snprintf(line + length, sizeof(line) - length, "%5.5s", 
+				info.nuclides[j]);
+		}
+		const bool resonance = setTypes && setTypes[i] == ReaclibKernel::kNarrowResonance;
+		const char flag = resonanceFlags ? resonanceFlags[i] : resonance ? 'r' : 'n';
+		length += snprintf(line + length, sizeof(line) - length, 
+			"        %s%c%c   %s          \n", label, flag, 
+			info.reverse ? info.reverse : ' ', qValue);
+
+		//The coefficients a0 through a3 followed by a4 through a6.
+		for (unsigned int j = 0; j < 7; j++) {
+			FormatFixedFloat(par[7 * i + j], 6, 13, line + length);
+			length += strlen(line + length);
+			if (j == 3) length += snprintf(line + length, sizeof(line) - length, 
+				"%22s\n", "");
+		}
+		length += snprintf(line + length, sizeof(line) - length, "%35s\n", "");
+		if (fwrite(line, 1, length, file_) != (size_t) length) success_ = false;
+	}
+	return success_;
+}
+
+bool ReaclibWriter::WriteLibrary(const RateLibraryView &library) {
+	double par[7 * ReaclibParser::kMaxSets];
+	ReaclibKernel::SetType setTypes[ReaclibParser::kMaxSets];
+	char resonanceFlags[ReaclibParser::kMaxSets];
+	for (size_t r = 0; r < library.numRates && success_; r++) {
+		const uint32_t first = library.rateOffsets[r];
+		const unsigned int numSets = library.rateOffsets[r + 1] - first;
+		if (numSets > ReaclibParser::kMaxSets) {
+			success_ = false;
+			return false;
+		}
+		for (unsigned int i = 0; i < numSets; i++) {
+			for (unsigned int j = 0; j < 7; j++) {
+				par[7 * i + j] = library.columns[j][first + i];
+			}
+			setTypes[i] = static_cast<ReaclibKernel::SetType>(library.setTypes[first + i]);
+			resonanceFlags[i] = library.resonanceFlags[first + i];
+		}
+		if (!WriteRate(library.reactions[r], par, numSets, setTypes, resonanceFlags)) {
+			return false;
+		}
+	}
+	return success_;
+}
+
+ReactionInfo ReaclibWriter::MakeReactionInfo(const unsigned int chapter, 
+	const char *const *nuclides, const unsigned int numNuclides, 
+	const char *label, const double qValue, const bool reverse
+) {
+	ReactionInfo info;
+	memset(&info, 0, sizeof(info));
+	for (unsigned int i = 0; i < numNuclides && i < ReactionInfo::kMaxNuclides; i++) {
+		strncpy(info.nuclides[i], nuclides[i], sizeof(info.nuclides[i]) - 1);
+	}
+	strncpy(info.label, label, sizeof(info.label) - 1);
+	info.chapter = chapter;
+	info.reverse = reverse ? 'v' : '\0';
+	info.qValue = qValue;
+	return info;
+}
@@ -0,0 +1,96 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef REACLIBWRITER_H
+#define REACLIBWRITER_H
+
+#include <cstddef>
+#include <cstdio>
+
+#include "RateLibrary.hpp"
+#include "ReaclibKernel.hpp"
+
+/**@brief Writes rates in the REACLIB version 2 text format.
+ * @author Karl Smith
+ *
+ * Every set is written as a chapter line, a set label line and two lines of 
+ * coefficients, as read by ReaclibParser. Each rate is formatted into a 
+ * fixed line buffer and streamed to the file, so thousands of refitted rates
+ * can be dumped in one pass:
+ * @code
+ * 	ReaclibWriter writer;
+ * 	writer.Open("refit.txt");
+ * 	for (size_t i = 0; i < rates.size(); i++) rates[i]->WriteReaclib(writer, infos[i]);
+ * @endcode
+ */
+class ReaclibWriter {
+	public:
+		/// @brief Default constructor.
+		ReaclibWriter();
+
+		/// @brief Closes the file.
+		~ReaclibWriter();
+
+		/// @brief Creates the output file, replacing any existing file.
+		/// @param[in] filename The path of the file.
+		/// @param[in] append If true the rates are appended to an existing file.
+		/// @return False if the file could not be opened.
+		bool Open(const char *filename, const bool append = false);
+
+		/// @brief Flushes and closes the file.
+		/// @return False if any write failed.
+		bool Close();
+
+		/// @brief Writes a rate.
+		/// @param[in] info The reaction the rate describes.
+		/// @param[in] par The 7 * numSets REACLIB parameters.
+		/// @param[in] numSets The number of sets in the rate.
+		/// @param[in] setTypes The structural type of each set, used for the 
+		///   resonance flag if no flags are given. If null every set is 
+		///   flagged non-resonant.
+		/// @param[in] resonanceFlags The REACLIB flag of each set, written 
+		///   unchanged. May be null.
+		/// @return False if the write failed or the rate has more than 
+		///   ReaclibParser::kMaxSets sets, in which case nothing is written.
+		bool WriteRate(const ReactionInfo &info, const double *par, 
+			const unsigned int numSets, 
+			const ReaclibKernel::SetType *setTypes = 0,
+			const char *resonanceFlags = 0
+		);
+
+		/// @brief Writes every rate of a library.
+		/// @param[in] library The rates to write.
+		/// @return False if a write failed or a rate has more than 
+		///   ReaclibParser::kMaxSets sets. The rates before it are written.
+		bool WriteLibrary(const RateLibraryView &library);
+
+		/// @brief Fills the reaction information of a rate.
+		/// @param[in] chapter The REACLIB chapter.
+		/// @param[in] nuclides The names of the nuclides, reactants first.
+		/// @param[in] numNuclides The number of nuclides, at most 6.
+		/// @param[in] label The label of the source, at most 4 characters.
+		/// @param[in] qValue The Q value in MeV.
+		/// @param[in] reverse True for a rate computed from detailed balance.
+		/// @return The reaction information.
+		static ReactionInfo MakeReactionInfo(const unsigned int chapter, 
+			const char *const *nuclides, const unsigned int numNuclides, 
+			const char *label, const double qValue, const bool reverse = false
+		);
+
+		/// @brief Formats a number as a fixed width REACLIB field.
+		/// @param[in] value The value to format.
+		/// @param[in] digits The number of digits after the decimal point.
+		/// @param[in] width The width of the field.
+		/// @param[out] out Buffer receiving width characters and a null.
+		static void FormatFixedFloat(const double value, const int digits, 
+			const int width, char *out);
+
+	private:
+		ReaclibWriter(const ReaclibWriter&) = delete;
+		ReaclibWriter& operator=(const ReaclibWriter&) = delete;
+
+		FILE *file_; ///< The output file.
+		bool success_; ///< False once a write has failed.
+};
+
+#endif //REACLIBWRITER_H
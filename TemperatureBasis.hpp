@@ -0,0 +1,73 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef TEMPERATUREBASIS_H
+#define TEMPERATUREBASIS_H
+
+#include <cmath>
+
+/**@brief The temperature terms of the REACLIB expression at a single T9.
+ * @author Karl Smith
+ *
+ * Every REACLIB set is evaluated from the same seven terms,
+ * @f$ (1, T_9^{-1}, T_9^{-1/3}, T_9^{1/3}, T_9, T_9^{5/3}, \ln T_9) @f$, 
+ * plus the factor @f$ T_9^{-3/2} @f$ shared by narrow resonances. The basis 
+ * is computed once from a single cube root, logarithm and square root and can
+ * then be passed to the evaluation of any number of rates at that 
+ * temperature, for example every rate of a network in one zone and step:
+ * @code
+ * 	TemperatureBasis basis(t9);
+ * 	for (size_t i = 0; i < rates.size(); i++) lambda[i] = rates[i]->EvaluateAt(basis);
+ * @endcode
+ */
+class TemperatureBasis {
+	public:
+		/// The index of each term, matching the parameter index within a set.
+		enum Term {
+			kConstant = 0, ///< 1, multiplies a0.
+			kInverse, ///< T9^-1, multiplies a1.
+			kInverseThird, ///< T9^-1/3, multiplies a2.
+			kThird, ///< T9^1/3, multiplies a3.
+			kLinear, ///< T9, multiplies a4.
+			kFiveThirds, ///< T9^5/3, multiplies a5.
+			kLog ///< ln T9, multiplies a6.
+		};
+		/// The number of terms in a set.
+		static const unsigned int kNumTerms = 7;
+		/// The number of stored terms, padded with a zero for aligned access.
+		static const unsigned int kPaddedTerms = 8;
+
+		/// @brief Computes the basis at the given temperature.
+		/// @param[in] t9 The temperature in GK.
+		explicit TemperatureBasis(const double t9) {
+			const double t9Third = cbrt(t9);
+			terms_[kConstant] = 1;
+			terms_[kThird] = t9Third;
+			terms_[kInverseThird] = 1. / t9Third;
+			terms_[kInverse] = terms_[kInverseThird] * terms_[kInverseThird] 
+				* terms_[kInverseThird];
+			terms_[kLinear] = t9;
+			terms_[kFiveThirds] = t9 * t9Third * t9Third;
+			terms_[kLog] = log(t9);
+			terms_[kNumTerms] = 0;
+			t9InvThreeHalves_ = terms_[kInverse] / sqrt(t9);
+		}
+
+		/// @brief Returns the temperature in GK.
+		double GetT9() const {return terms_[kLinear];}
+
+		/// @brief Returns the specified term.
+		double operator[](const unsigned int term) const {return terms_[term];}
+
+		/// @brief Returns a pointer to the kPaddedTerms terms.
+		const double* GetTerms() const {return terms_;}
+
+		/// @brief Returns @f$ T_9^{-3/2} @f$.
+		double GetT9InvThreeHalves() const {return t9InvThreeHalves_;}
+
+	private:
+		alignas(64) double terms_[kPaddedTerms]; ///< The terms, indexed by Term.
+		double t9InvThreeHalves_; ///< The narrow resonance factor T9^-3/2.
+};
+
+#endif //TEMPERATUREBASIS_H
@@ -0,0 +1,223 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Measures the evaluation and fitting speed of ReaclibModel and RateLibrary
+ *  on synthetic rates, to provide a baseline for comparing changes. The
+ *  results are written to stdout as JSON, or as CSV with the option --csv. The
+ *  program is built by the ReaclibBenchmark target of CMakeLists.txt:
+ *  @code
+ *  	cmake -S . -B build && cmake --build build --target ReaclibBenchmark
+ *  @endcode
+ *  The measurements of the TF1 interface of ReaclibRate, evaluate and fit,
+ *  are only made if ROOT is found, which defines REACLIB_BENCHMARK_ROOT.
+ *  The synthetic rates and the sampled temperatures are fixed, so runs on the
+ *  same machine are comparable. Each measurement is repeated and the median
+ *  is reported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "RateLibrary.hpp"
+#include "ReaclibFitter.hpp"
+#include "ReaclibKernel.hpp"
+#include "ReaclibModel.hpp"
+#ifdef REACLIB_BENCHMARK_ROOT
+#include "ReaclibRate.hpp"
+#endif
+
+namespace {
+	/// The numbers of resonances of the synthetic rates.
+	const unsigned int kNumResonances[] = {0, 1, 5, 20};
+	/// The suffix of the name of a benchmark for each ReaclibKernel::Accuracy.
+	const char *kTierSuffix[] = {"", "_high", "_fast"};
+	/// The number of measurements of which the median is reported.
+	const int kRepeats = 5;
+	/// The minimum duration of a measurement in seconds.
+	const double kMinDuration = 0.05;
+
+	/// The outcome of a benchmark.
+	struct Result {
+		std::string name; ///< The name of the benchmark.
+		unsigned int numResonances; ///< The number of resonances of the rate.
+		double nsPerOp; ///< The median time per operation in ns.
+		size_t opsPerMeasurement; ///< The number of operations in a measurement.
+	};
+
+	/// Keeps the evaluated values from being optimized away.
+	volatile double sink;
+
+	/**Returns the temperatures spaced logarithmically from 0.01 to 10 GK.
+	 */
+	std::vector<double> MakeGrid(const size_t n) {
+		std::vector<double> t9(n);
+		for (size_t i = 0; i < n; i++) t9[i] = 0.01 * pow(1000., i / (n - 1.));
+		return t9;
+	}
+
+	/**Sets up the synthetic rate, a ReaclibModel or a ReaclibRate: 12C(p,g)
+	 * like reactants with S(0) of 1.5 keV b and resonances spaced
+	 * logarithmically from 0.05 to 3 MeV with decreasing strength.
+	 */
+	template <class Rate>
+	void Setup(Rate &rate, const unsigned int numResonances) {
+		rate.SetSFactor(1.5e-3);
+		for (unsigned int i = 0; i < numResonances; i++) {
+			const double fraction = numResonances > 1 ? i / (numResonances - 1.) : 0.5;
+			rate.SetResonance(i, 0.05 * pow(60., fraction), 1e-3 * pow(10., -2 * fraction));
+		}
+	}
+
+	/**Times the operation, calibrating the number of calls so a measurement
+	 * lasts at least kMinDuration, and returns the median time per operation
+	 * in ns. Each call performs opsPerCall operations.
+	 */
+	template <class Function>
+	Result Measure(const std::string &name, const unsigned int numResonances,
+		const size_t opsPerCall, Function function
+	) {
+		typedef std::chrono::steady_clock Clock;
+		size_t calls = 1;
+		while (true) {
+			const Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < calls; i++) function();
+			const double duration = std::chrono::duration<double>(Clock::now() - start).count();
+			if (duration >= kMinDuration) break;
+			calls *= duration > 0 ? std::min(10., 1.2 * kMinDuration / duration) : 10;
+		}
+
+		std::vector<double> times;
+		for (int r = 0; r < kRepeats; r++) {
+			const Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < calls; i++) function();
+			times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+		}
+		std::sort(times.begin(), times.end());
+		Result result;
+		result.name = name;
+		result.numResonances = numResonances;
+		result.opsPerMeasurement = calls * opsPerCall;
+		result.nsPerOp = times[kRepeats / 2] / result.opsPerMeasurement;
+		return result;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	const bool csv = argc > 1 && !strcmp(argv[1], "--csv");
+	std::vector<Result> results;
+	const std::vector<double> grid = MakeGrid(4096);
+	std::vector<double> out(grid.size());
+
+	for (const unsigned int numResonances : kNumResonances) {
+		ReaclibModel model(numResonances, 6, 1, 12. / 13);
+		Setup(model, numResonances);
+
+		//The model, one point per call.
+		results.push_back(Measure("model_evaluate", numResonances, grid.size(), [&]() {
+			double sum = 0;
+			for (size_t i = 0; i < grid.size(); i++) sum += model.Evaluate(grid[i]);
+			sink = sum;
+		}));
+
+		for (int accuracy = 0; accuracy < 3; accuracy++) {
+			results.push_back(Measure(std::string("evaluate_batch") + kTierSuffix[accuracy],
+				numResonances, grid.size(), [&]() {
+					model.EvaluateBatch(grid.data(), out.data(), grid.size(),
+						static_cast<ReaclibKernel::Accuracy>(accuracy));
+					sink = out[0];
+				}));
+		}
+
+		//Fit the strengths of the resonances and the energy dependence of the
+		//S-factor to the rate from a start with every strength doubled.
+		const size_t numPoints = 100;
+		const std::vector<double> t9 = MakeGrid(numPoints);
+		std::vector<double> table(numPoints);
+		model.EvaluateBatch(t9.data(), table.data(), numPoints);
+		ReaclibModel start = model;
+		for (unsigned int i = 0; i < numResonances; i++) {
+			start.ReleaseParameter(7 * (i + 1));
+			start.SetParameter(7 * (i + 1), model.GetParameter(7 * (i + 1)) + log(2.));
+		}
+		ReaclibFitter fitter;
+		results.push_back(Measure("model_fit", numResonances, 1, [&]() {
+			ReaclibModel fit = start;
+			sink = fitter.Fit(fit, t9.data(), table.data(), 0, numPoints);
+		}));
+
+#ifdef REACLIB_BENCHMARK_ROOT
+		//The TF1 interface, one point per call.
+		ReaclibRate rate("benchmark", numResonances, 6, 1, 12. / 13);
+		Setup(rate, numResonances);
+		std::vector<double> par(rate.GetParameters(), rate.GetParameters() + rate.GetNpar());
+		results.push_back(Measure("evaluate", numResonances, grid.size(), [&]() {
+			double sum = 0;
+			for (size_t i = 0; i < grid.size(); i++) {
+				double t9 = grid[i];
+				sum += rate.Evaluate(&t9, par.data());
+			}
+			sink = sum;
+		}));
+
+		//The same fit through the TF1 parameters.
+		for (unsigned int i = 0; i < numResonances; i++) {
+			rate.SetParLimits(7 * (i + 1), 0, 0);
+			rate.SetParameter(7 * (i + 1), par[7 * (i + 1)] + log(2.));
+		}
+		const std::vector<double> rateStart(rate.GetParameters(),
+			rate.GetParameters() + rate.GetNpar());
+		results.push_back(Measure("fit", numResonances, 1, [&]() {
+			rate.SetParameters(rateStart.data());
+			sink = rate.FitNative(t9.data(), table.data(), 0, numPoints);
+		}));
+#endif
+	}
+
+	//A library cycling through the synthetic rates, evaluated at each grid
+	//temperature.
+	const size_t numRates = 1000;
+	RateLibrary library;
+	for (size_t r = 0; r < numRates; r++) {
+		const unsigned int numResonances = kNumResonances[r % 4];
+		ReaclibModel model(numResonances, 6, 1, 12. / 13);
+		Setup(model, numResonances);
+		library.AddRate(model.GetParameters(), model.GetNumSets(), model.GetSetTypes());
+	}
+	std::vector<double> rates(numRates);
+	const size_t numTemperatures = 64;
+	for (int accuracy = 0; accuracy < 3; accuracy++) {
+		results.push_back(Measure(std::string("library_evaluate_mixed") + kTierSuffix[accuracy],
+			0, numRates * numTemperatures, [&]() {
+				for (size_t i = 0; i < numTemperatures; i++) {
+					library.Evaluate(grid[i * grid.size() / numTemperatures], rates.data(),
+						static_cast<ReaclibKernel::Accuracy>(accuracy));
+				}
+				sink = rates[0];
+			}));
+	}
+
+	if (csv) {
+		printf("name,num_resonances,ns_per_op,ops\n");
+		for (const Result &result : results) {
+			printf("%s,%u,%.4g,%zu\n", result.name.c_str(), result.numResonances,
+				result.nsPerOp, result.opsPerMeasurement);
+		}
+		return 0;
+	}
+	printf("{\n  \"instruction_set\": \"%s\",\n  \"benchmarks\": [\n",
+		ReaclibKernel::GetInstructionSet());
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &result = results[i];
+		printf("    {\"name\": \"%s\", \"num_resonances\": %u, \"ns_per_op\": %.4g, "
+			"\"ops\": %zu}%s\n", result.name.c_str(), result.numResonances,
+			result.nsPerOp, result.opsPerMeasurement,
+			i + 1 < results.size() ? "," : "");
+	}
+	printf("  ]\n}\n");
+	return 0;
+}
@@ -0,0 +1,25 @@
+/// @file
+/// @author Karl Smith
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+/// The number of failed checks of the test program.
+static int numFailures = 0;
+
+/// @brief Reports a failed condition with its location and counts it.
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		numFailures++; \
+	} \
+} while (0)
+
+/// @brief Checks that two values agree to the relative tolerance.
+#define CHECK_CLOSE(value, expected, tolerance) \
+	CHECK(std::fabs((value) - (expected)) <= (tolerance) * std::fabs(expected))
+
+#endif //CHECK_H
@@ -0,0 +1,149 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Writes a binary library, rewrites it with more rates and checks the
+ *  mapped file evaluates like the libraries it was written from. Copies of
+ *  the file with a damaged header or arrays must be rejected by
+ *  RateLibraryFile::Open.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "RateLibrary.hpp"
+#include "RateLibraryFile.hpp"
+#include "ReaclibModel.hpp"
+
+namespace {
+	const char *kFilename = "RateLibraryFileTest.rlib";
+	const char *kCorruptFilename = "RateLibraryFileTest_corrupt.rlib";
+
+	/**Adds a 12C(p,g) like rate with the given number of resonances.
+	 */
+	void AddRate(RateLibrary &library, const unsigned int numResonances,
+		const char *resonanceFlags = 0
+	) {
+		ReaclibModel model(numResonances, 6, 1, 12. / 13);
+		model.SetSFactor(1.5e-3);
+		for (unsigned int i = 0; i < numResonances; i++) {
+			model.SetResonance(i, 0.1 * (i + 1), 1e-3 / (i + 1));
+		}
+		library.AddRate(model.GetParameters(), model.GetNumSets(),
+			model.GetSetTypes(), 0.01, 10, 0, resonanceFlags);
+	}
+
+	/**Returns the contents of a file, empty if it cannot be read.
+	 */
+	std::string ReadFile(const char *filename) {
+		std::string contents;
+		FILE *file = fopen(filename, "rb");
+		if (!file) return contents;
+		char buffer[4096];
+		size_t n;
+		while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) contents.append(buffer, n);
+		fclose(file);
+		return contents;
+	}
+
+	/**Writes the contents to the corrupt file and returns whether it opens.
+	 * A rejected file must leave the library closed and empty.
+	 */
+	bool OpensCorrupt(const std::string &contents) {
+		FILE *file = fopen(kCorruptFilename, "wb");
+		if (!file) return true;
+		fwrite(contents.data(), 1, contents.size(), file);
+		fclose(file);
+
+		RateLibraryFile library;
+		CHECK(library.Open(kFilename));
+		const bool opened = library.Open(kCorruptFilename);
+		if (!opened) {
+			CHECK(!library.IsOpen());
+			CHECK(library.GetNumRates() == 0);
+		}
+		return opened;
+	}
+
+	/**Overwrites the set offset of a rate in the file contents.
+	 */
+	void SetRateOffset(std::string &contents, const size_t rateId, const uint32_t offset) {
+		RateLibraryFile::Header header;
+		memcpy(&header, contents.data(), sizeof(header));
+		memcpy(&contents[header.rateOffsetOffset + rateId * sizeof(offset)], &offset,
+			sizeof(offset));
+	}
+}
+
+int main() {
+	RateLibrary first, second;
+	AddRate(first, 0);
+	AddRate(first, 2);
+	const char flags[] = {'n', 'w'};
+	AddRate(second, 1, flags);
+
+	CHECK(RateLibraryFile::Write(first, kFilename));
+	CHECK(RateLibraryFile::RewriteAppended(kFilename, second));
+
+	RateLibraryFile file;
+	CHECK(file.Open(kFilename));
+	CHECK(file.GetNumRates() == 3);
+	if (file.GetNumRates() != 3) return 1;
+	const RateLibraryView &view = file.GetView();
+	CHECK(view.numSets == 6);
+	CHECK(view.rateOffsets[3] == 6);
+	CHECK(view.resonanceFlags[4] == 'n');
+	CHECK(view.resonanceFlags[5] == 'w');
+
+	for (const double t9 : {0.05, 0.3, 2.}) {
+		double expected[3], rates[3];
+		first.Evaluate(t9, expected);
+		second.Evaluate(t9, expected + 2);
+		file.Evaluate(t9, rates);
+		for (int r = 0; r < 3; r++) CHECK_CLOSE(rates[r], expected[r], 1e-14);
+	}
+	file.Close();
+	CHECK(!file.IsOpen());
+
+	const std::string contents = ReadFile(kFilename);
+	CHECK(contents.size() > sizeof(RateLibraryFile::Header));
+	if (contents.size() <= sizeof(RateLibraryFile::Header)) return 1;
+	RateLibraryFile::Header header;
+	memcpy(&header, contents.data(), sizeof(header));
+	CHECK(!OpensCorrupt(contents.substr(0, contents.size() - 1)));
+	{
+		std::string corrupt = contents;
+		corrupt[0] = 'X';
+		CHECK(!OpensCorrupt(corrupt));
+	}
+	{
+		std::string corrupt = contents;
+		SetRateOffset(corrupt, 1, header.numSets + 1);
+		CHECK(!OpensCorrupt(corrupt));
+	}
+	{
+		std::string corrupt = contents;
+		SetRateOffset(corrupt, 1, 2);
+		SetRateOffset(corrupt, 2, 1);
+		CHECK(!OpensCorrupt(corrupt));
+	}
+	{
+		std::string corrupt = contents;
+		corrupt[header.setTypeOffset] = 7;
+		CHECK(!OpensCorrupt(corrupt));
+	}
+	CHECK(OpensCorrupt(contents));
+
+	//Without an existing file only the new rates are written.
+	remove(kFilename);
+	CHECK(RateLibraryFile::RewriteAppended(kFilename, second));
+	CHECK(file.Open(kFilename));
+	CHECK(file.GetNumRates() == 1);
+
+	file.Close();
+	remove(kFilename);
+	remove(kCorruptFilename);
+	return numFailures ? 1 : 0;
+}
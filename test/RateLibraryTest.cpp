@@ -0,0 +1,59 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Fills a RateLibrary with rates of different numbers of sets, spanning
+ *  several chunks of the library evaluation, and checks every rate agrees
+ *  with ReaclibModel::Evaluate of the same parameters. The test is also run
+ *  with REACLIB_ISA lowering the vector exponential to AVX2 and to the math
+ *  library.
+ */
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "RateLibrary.hpp"
+#include "ReaclibModel.hpp"
+
+int main() {
+	//Up to three resonances per rate, a general non-resonant set in every
+	//tenth rate and a rate without sets in the middle.
+	const size_t numRates = 150;
+	const size_t emptyRate = 75;
+	std::vector<ReaclibModel> models;
+	RateLibrary library;
+	for (size_t r = 0; r < numRates; r++) {
+		if (r == emptyRate) library.AddRate(0, 0);
+		const unsigned int z1 = 1 + r % 8, z2 = 1 + r % 3;
+		ReaclibModel model(r % 4, z1, z2, z1 * z2 / (z1 + z2 + 0.1f));
+		model.SetSFactor(1e-3f * (1 + r % 5));
+		for (unsigned int i = 0; i < model.GetNumSets() - 1; i++) {
+			model.SetResonance(i, 0.1f * (i + 1) + 0.01f * (r % 7), 1e-3f);
+		}
+		if (r % 10 == 0) model.SetParameter(1, 0.1);
+		library.AddRate(model.GetParameters(), model.GetNumSets(), model.GetSetTypes());
+		models.push_back(model);
+	}
+	CHECK(library.GetNumRates() == numRates + 1);
+	CHECK(library.GetNumSets() > 256);
+
+	//The resonances are summed with their T9^-3/2 factor inside the
+	//exponential, so the last bits may differ as in ReaclibKernelTest. Values
+	//below DBL_MIN may be flushed to zero.
+	const double bound[] = {1e-12, 1.1e-12, 1.2e-7};
+	std::vector<double> rates(library.GetNumRates());
+	for (int tier = 0; tier < 3; tier++) {
+		const ReaclibKernel::Accuracy accuracy = static_cast<ReaclibKernel::Accuracy>(tier);
+		for (double t9 = 0.01; t9 <= 10; t9 *= 1.5) {
+			library.Evaluate(t9, rates.data(), accuracy);
+			CHECK(rates[emptyRate] == 0);
+			for (size_t r = 0; r < numRates; r++) {
+				const double expected = models[r].Evaluate(t9);
+				const double rate = rates[r < emptyRate ? r : r + 1];
+				CHECK(std::fabs(rate - expected) <= bound[tier] * expected + DBL_MIN);
+			}
+		}
+	}
+	return numFailures ? 1 : 0;
+}
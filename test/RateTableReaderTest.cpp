@@ -0,0 +1,112 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Writes small column and STARLIB fixtures and checks RateTableReader reads
+ *  their tables, including Fortran exponents, DOS line endings, skipped
+ *  points, a table without uncertainties and a malformed row.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "Check.hpp"
+#include "RateTable.hpp"
+#include "RateTableReader.hpp"
+
+namespace {
+	/**Writes a string to a file.
+	 */
+	bool WriteFile(const char *filename, const char *contents) {
+		FILE *file = fopen(filename, "wb");
+		if (!file) return false;
+		const bool success = fputs(contents, file) >= 0;
+		return fclose(file) == 0 && success;
+	}
+}
+
+int main() {
+	const char *filename = "RateTableReaderTest.txt";
+	RateTableReader reader;
+	RateTable table;
+
+	//Two tables separated by a header, the second without uncertainties and
+	//with DOS line endings. The point with a zero rate is skipped.
+	CHECK(WriteFile(filename,
+		"# T9    rate      factor\n"
+		"0.01    1.0D-05   1.2\n"
+		"0.1,    2.5E-02,  1.1\n"
+		"1.0     0.0       1.5\n"
+		"10      3.0e+01   1.3\n"
+		"\n"
+		"! second table\r\n"
+		"0.05  4.0E-03\r\n"
+		"0.5   6.0E-01\r\n"));
+	CHECK(reader.LoadColumns(filename, table) == 2);
+	CHECK(table.GetNumTables() == 2);
+	CHECK(table.GetTotalPoints() == 5);
+	if (table.GetNumTables() == 2) {
+		CHECK(table.GetNumPoints(0) == 3 && table.GetNumPoints(1) == 2);
+		const double t9[] = {0.01, 0.1, 10}, rate[] = {1e-5, 2.5e-2, 30}, factor[] = {1.2, 1.1, 1.3};
+		const double *factors = table.GetUncertaintyFactor(0);
+		CHECK(factors && table.GetSigma(0));
+		for (size_t i = 0; i < 3; i++) {
+			CHECK_CLOSE(table.GetT9(0)[i], t9[i], 1e-15);
+			CHECK_CLOSE(table.GetRate(0)[i], rate[i], 1e-15);
+			if (factors) CHECK_CLOSE(factors[i], factor[i], 1e-15);
+		}
+		CHECK(!table.GetUncertaintyFactor(1) && !table.GetSigma(1));
+		CHECK_CLOSE(table.GetT9(1)[1], 0.5, 1e-15);
+		CHECK_CLOSE(table.GetRate(1)[1], 0.6, 1e-15);
+	}
+
+	//Keeping points with a zero rate, with the columns in another order.
+	RateTable reordered;
+	reader.SetSkipNonPositive(false);
+	reader.SetColumns(1, 0, -1);
+	CHECK(WriteFile(filename, "1e-5 0.01\n0 1\n"));
+	CHECK(reader.LoadColumns(filename, reordered) == 1);
+	CHECK(reordered.GetNumPoints(0) == 2);
+	CHECK(reordered.GetT9(0)[1] == 1 && reordered.GetRate(0)[1] == 0);
+	reader.SetSkipNonPositive(true);
+	reader.SetColumns(0, 1);
+
+	//A row without a rate fails on its line and keeps the complete table.
+	CHECK(WriteFile(filename, "0.01 1e-5\n\n0.1 2e-2\n0.2\n"));
+	CHECK(reader.LoadColumns(filename, table) == -1);
+	CHECK(reader.GetLineNumber() == 4);
+	CHECK(table.GetNumTables() == 3);
+	CHECK(table.GetTotalPoints() == 6);
+	CHECK(reader.LoadColumns("RateTableReaderTest.missing", table) == -1);
+	CHECK(reader.GetLineNumber() == 0);
+
+	//Two STARLIB rates, the reaction taken from the set label.
+	CHECK(WriteFile(filename,
+		"4\n"
+		"       c12    p  n13                       ls09n     1.94300e+00          \n"
+		"1.000E-02 1.551E-24 1.080E+00\n"
+		"1.000E-01 3.812E-12 1.080E+00\n"
+		"4\n"
+		"       n14    p  o15                       im05n     7.29700e+00\n"
+		"5.000E-02 2.000E-15 1.200E+00\n"));
+	RateTable starlib;
+	CHECK(reader.LoadStarlib(filename, starlib) == 2);
+	CHECK(starlib.GetNumTables() == 2);
+	if (starlib.GetNumTables() == 2) {
+		CHECK(starlib.GetNumPoints(0) == 2 && starlib.GetNumPoints(1) == 1);
+		CHECK_CLOSE(starlib.GetRate(0)[1], 3.812e-12, 1e-15);
+		CHECK_CLOSE(starlib.GetUncertaintyFactor(1)[0], 1.2, 1e-15);
+		const ReactionInfo &info = starlib.GetReactionInfo(1);
+		CHECK(info.chapter == 4);
+		CHECK(!strcmp(info.nuclides[0], "n14") && !strcmp(info.nuclides[2], "o15"));
+		CHECK(!strcmp(info.label, "im05"));
+		CHECK_CLOSE(info.qValue, 7.297, 1e-12);
+	}
+
+	//Rows before the first chapter are malformed.
+	CHECK(WriteFile(filename, "1.000E-02 1.551E-24 1.080E+00\n"));
+	CHECK(reader.LoadStarlib(filename, starlib) == -1);
+	CHECK(starlib.GetNumTables() == 2);
+
+	remove(filename);
+	return numFailures ? 1 : 0;
+}
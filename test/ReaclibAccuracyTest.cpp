@@ -0,0 +1,69 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Checks the error bound of each ReaclibKernel::Accuracy tier against
+ *  std::exp, for the exponential itself and for the batched evaluation of a
+ *  rate, including arguments that underflow or overflow.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibKernel.hpp"
+#include "ReaclibModel.hpp"
+
+namespace {
+	/// The relative error bound of each tier, see ReaclibKernel::Accuracy.
+	const double kBound[] = {
+		2 * std::numeric_limits<double>::epsilon(), 1.1e-12, 1.1e-7
+	};
+}
+
+int main() {
+	//Arguments whose exponential is a normal number.
+	std::mt19937_64 generator(1);
+	std::uniform_real_distribution<double> uniform(-708, 709);
+	const size_t n = 100000;
+	std::vector<double> x(n), y(n);
+	for (size_t i = 0; i < n; i++) x[i] = uniform(generator);
+
+	for (int tier = 0; tier < 3; tier++) {
+		const ReaclibKernel::Accuracy accuracy = static_cast<ReaclibKernel::Accuracy>(tier);
+		ReaclibKernel::Exp(x.data(), y.data(), n, accuracy);
+		double maxError = 0;
+		for (size_t i = 0; i < n; i++) {
+			const double expected = exp(x[i]);
+			maxError = std::max(maxError, std::fabs(y[i] - expected) / expected);
+		}
+		CHECK(maxError <= kBound[tier]);
+
+		//Underflow to zero, overflow to infinity and the special values.
+		const double inf = std::numeric_limits<double>::infinity();
+		double special[] = {-800, -746, 710, 800, -inf, inf};
+		const double expected[] = {0, 0, inf, inf, 0, inf};
+		ReaclibKernel::Exp(special, special, 6, accuracy);
+		for (int i = 0; i < 6; i++) CHECK(special[i] == expected[i]);
+		double nan = std::numeric_limits<double>::quiet_NaN();
+		ReaclibKernel::Exp(&nan, &nan, 1, accuracy);
+		CHECK(std::isnan(nan));
+
+		//The rate sums positive set contributions, so it keeps the bound of
+		//the tier. The exponents reach about a hundred at 0.01 GK, so the last
+		//bit of the temperature terms may add up to a few 1e-14.
+		ReaclibModel model(3, 6, 1, 12. / 13);
+		model.SetSFactor(1.5e-3);
+		for (unsigned int r = 0; r < 3; r++) model.SetResonance(r, 0.1 * (r + 1), 1e-3);
+		const size_t numT9 = 257;
+		std::vector<double> t9(numT9), rate(numT9);
+		for (size_t i = 0; i < numT9; i++) t9[i] = 0.01 * pow(1000., i / (numT9 - 1.));
+		model.EvaluateBatch(t9.data(), rate.data(), numT9, accuracy);
+		for (size_t i = 0; i < numT9; i++) {
+			CHECK_CLOSE(rate[i], model.Evaluate(t9[i]), kBound[tier] + 1e-13);
+		}
+	}
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Fits several tables with ReaclibBatchFitter over a pool of threads and
+ *  checks every job reproduces a sequential ReaclibFitter fit of the same
+ *  model exactly, as well as a sequential ReaclibMultiStart fit when the jobs
+ *  are fit from several starts.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "RateLibrary.hpp"
+#include "ReaclibBatchFitter.hpp"
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibMultiStart.hpp"
+
+namespace {
+	const size_t kNumJobs = 12;
+	const size_t kNumPoints = 40;
+
+	/**Builds the job model as ReaclibBatchFitter::AddJob does.
+	 */
+	ReaclibModel MakeModel(const ReaclibBatchFitter::Job &job) {
+		ReaclibModel model(job.numResonances, job.z1, job.z2, job.mu);
+		if (job.sFactor > 0) model.SetSFactor(job.sFactor);
+		for (unsigned int i = 0; i < job.energies.size(); i++) {
+			model.SetResonance(i, job.energies[i], job.strengths[i]);
+			if (job.freeResonances[i]) {
+				model.ReleaseParameter(7 * (i + 1));
+				model.ReleaseParameter(7 * (i + 1) + 1);
+			}
+		}
+		return model;
+	}
+
+	/**Checks two fitted models and their results are identical.
+	 */
+	void CheckSame(const ReaclibModel &model, const ReaclibFitter::Result &result,
+		const ReaclibModel &expected, const ReaclibFitter::Result &expectedResult
+	) {
+		CHECK(result.chi2 == expectedResult.chi2);
+		CHECK(result.iterations == expectedResult.iterations);
+		CHECK(result.ndf == expectedResult.ndf);
+		for (unsigned int i = 0; i < model.GetNumParameters(); i++) {
+			CHECK(model.GetParameter(i) == expected.GetParameter(i));
+		}
+	}
+}
+
+int main() {
+	//A table per job from a rate with one resonance, half of them with 10 %
+	//uncertainties. The fits start from a shifted resonance with S(0) free,
+	//or fixed for every third job.
+	std::vector<std::vector<double> > t9(kNumJobs), rate(kNumJobs), sigma(kNumJobs);
+	ReaclibBatchFitter batch;
+	batch.SetNumThreads(4);
+	std::vector<ReaclibBatchFitter::Job> jobs;
+	for (size_t j = 0; j < kNumJobs; j++) {
+		const unsigned int z1 = 3 + j % 6;
+		const float mu = z1 / (z1 + 1.f);
+		const float energy = 0.3f + 0.05f * j;
+		ReaclibModel truth(1, z1, 1, mu);
+		truth.SetSFactor(1e-3f * (1 + j % 4));
+		truth.SetResonance(0, energy, 1e-2f);
+
+		t9[j].resize(kNumPoints);
+		rate[j].resize(kNumPoints);
+		for (size_t i = 0; i < kNumPoints; i++) t9[j][i] = 0.05 * pow(100., i / (kNumPoints - 1.));
+		truth.EvaluateBatch(t9[j].data(), rate[j].data(), kNumPoints);
+		for (size_t i = 0; i < kNumPoints; i++) sigma[j].push_back(0.1 * rate[j][i]);
+
+		ReaclibBatchFitter::Job job(z1, 1, mu, 1);
+		job.SetData(t9[j].data(), rate[j].data(), j % 2 ? sigma[j].data() : 0, kNumPoints);
+		if (j % 3 == 0) job.SetSFactor(1e-3f * (1 + j % 4));
+		job.AddResonance(1.2f * energy, 3e-2f, true);
+		CHECK(batch.AddJob(job) == j);
+		jobs.push_back(job);
+	}
+	CHECK(batch.GetNumJobs() == kNumJobs);
+	CHECK(batch.Run() == kNumJobs);
+
+	ReaclibFitter fitter;
+	for (size_t j = 0; j < kNumJobs; j++) {
+		ReaclibModel expected = MakeModel(jobs[j]);
+		ReaclibFitter::Result expectedResult;
+		CHECK(fitter.Fit(expected, jobs[j].t9, jobs[j].rate, jobs[j].sigma, kNumPoints,
+			&expectedResult));
+		CHECK(batch.GetSuccess(j));
+		CheckSame(batch.GetModel(j), batch.GetResult(j), expected, expectedResult);
+		CHECK(batch.GetErrors(j) == fitter.GetErrors());
+		CHECK(batch.GetResult(j).chi2 < 1e-12);
+	}
+
+	//Every rate is added with the temperature range of its table.
+	RateLibrary library;
+	CHECK(batch.AddToLibrary(library) == kNumJobs);
+	CHECK(library.GetNumRates() == kNumJobs);
+	double t9Min, t9Max;
+	library.GetValidityRange(0, t9Min, t9Max);
+	CHECK(t9Min == t9[0].front() && t9Max == t9[0].back());
+
+	//Fits from several starts run on the thread of their job.
+	ReaclibBatchFitter multiBatch;
+	multiBatch.SetNumThreads(4);
+	multiBatch.SetNumStarts(8);
+	for (size_t j = 0; j < kNumJobs; j++) multiBatch.AddJob(jobs[j]);
+	CHECK(multiBatch.Run() == kNumJobs);
+	ReaclibMultiStart multiStart;
+	multiStart.SetNumStarts(8);
+	multiStart.SetNumThreads(1);
+	for (size_t j = 0; j < kNumJobs; j++) {
+		ReaclibModel expected = MakeModel(jobs[j]);
+		ReaclibFitter::Result expectedResult;
+		CHECK(multiStart.Fit(expected, jobs[j].t9, jobs[j].rate, jobs[j].sigma,
+			kNumPoints, &expectedResult));
+		CheckSame(multiBatch.GetModel(j), multiBatch.GetResult(j), expected, expectedResult);
+		CHECK(multiBatch.GetErrors(j) == multiStart.GetErrors());
+	}
+	return numFailures ? 1 : 0;
+}
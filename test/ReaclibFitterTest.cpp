@@ -0,0 +1,59 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Fits a table generated from known parameters and checks ReaclibFitter
+ *  recovers them. The non-resonant a1 and a resonance a4, which the
+ *  structural set types skip, are released, so the fit must treat both sets
+ *  in the general form and the fitted model must keep that form.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+
+int main() {
+	ReaclibModel truth(1, 6, 1, 12. / 13);
+	truth.SetSFactor(1.5e-3);
+	truth.SetResonance(0, 0.422, 8.6e-3);
+	truth.SetParameter(1, -0.5);
+	truth.SetParameter(7 + 4, 0.05);
+
+	const size_t n = 60;
+	std::vector<double> t9(n), rate(n);
+	for (size_t i = 0; i < n; i++) t9[i] = 0.05 * pow(100., i / (n - 1.));
+	truth.EvaluateBatch(t9.data(), rate.data(), n);
+
+	//Start from the structural form: no a1 and no a4, with the S-factor
+	//free and doubled.
+	ReaclibModel model = truth;
+	model.ReleaseParameter(0);
+	model.SetParameter(0, truth.GetParameter(0) + log(2.));
+	model.ReleaseParameter(1);
+	model.SetParameter(1, 0);
+	model.ReleaseParameter(7 + 4);
+	model.SetParameter(7 + 4, 0);
+
+	ReaclibFitter fitter;
+	ReaclibFitter::Result result;
+	CHECK(fitter.Fit(model, t9.data(), rate.data(), 0, n, &result));
+	CHECK(result.converged);
+	CHECK(result.chi2 < 1e-16);
+	CHECK(result.ndf == n - 6);
+	CHECK_CLOSE(model.GetParameter(0), truth.GetParameter(0), 1e-6);
+	CHECK_CLOSE(model.GetParameter(1), -0.5, 1e-6);
+	CHECK_CLOSE(model.GetParameter(7 + 4), 0.05, 1e-6);
+
+	//The fitted model must evaluate the function that was fit.
+	CHECK(model.GetSetType(0) == ReaclibKernel::kGeneral);
+	CHECK(model.GetSetType(1) == ReaclibKernel::kGeneral);
+	std::vector<double> fitted(n);
+	model.EvaluateBatch(t9.data(), fitted.data(), n);
+	for (size_t i = 0; i < n; i++) {
+		CHECK_CLOSE(fitted[i], rate[i], 1e-8);
+		CHECK_CLOSE(model.Evaluate(t9[i]), rate[i], 1e-8);
+	}
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Checks the single temperature kernels of ReaclibKernel against each other
+ *  on a rate with a non-resonant set, narrow resonances and a general set,
+ *  including the logarithm where the rate underflows, the gradient and the
+ *  temperature derivative against finite differences and the batch kernel of
+ *  the selected instruction set against them. The test is also run with
+ *  REACLIB_ISA lowering the selection to AVX2 and to the scalar kernel.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibKernel.hpp"
+#include "TemperatureBasis.hpp"
+
+namespace {
+	const unsigned int kNumSets = 4;
+	/// A 12C(p,g) like rate with two resonances and a general set.
+	const double kPar[7 * kNumSets] = {
+		17.1482, 0, -13.692, -0.230881, 4.44362, -3.15898, -2. / 3,
+		17.5428, -3.77849, 0, 0, 0, 0, -1.5,
+		-1.54567, -4.25653, 0, 0, 0, 0, -1.5,
+		2.1, -0.3, -1.2, 0.4, -0.05, 0.002, 0.7
+	};
+	const ReaclibKernel::SetType kSetTypes[kNumSets] = {
+		ReaclibKernel::kNonResonant, ReaclibKernel::kNarrowResonance,
+		ReaclibKernel::kNarrowResonance, ReaclibKernel::kGeneral
+	};
+
+	/**Returns temperatures spaced logarithmically from 0.001 to 10 GK, low
+	 * enough for the non-resonant set to underflow.
+	 */
+	std::vector<double> MakeGrid(const size_t n) {
+		std::vector<double> t9(n);
+		for (size_t i = 0; i < n; i++) t9[i] = 0.001 * pow(1e4, i / (n - 1.));
+		return t9;
+	}
+
+	/**Checks ReaclibKernel::EvaluateWithExponents returns the values of
+	 * Evaluate and EvaluateLog and the exponents of SetExponent.
+	 */
+	void CheckExponents(const std::vector<double> &grid) {
+		for (const double t9 : grid) {
+			const TemperatureBasis basis(t9);
+			double exponents[kNumSets], logExponents[kNumSets];
+			CHECK(ReaclibKernel::EvaluateWithExponents(basis, kPar, kSetTypes, kNumSets,
+				exponents) == ReaclibKernel::Evaluate(basis, kPar, kSetTypes, kNumSets));
+			CHECK(ReaclibKernel::EvaluateWithExponents(basis, kPar, kSetTypes, kNumSets,
+				logExponents, true) == ReaclibKernel::EvaluateLog(basis, kPar, kSetTypes, kNumSets));
+			for (unsigned int i = 0; i < kNumSets; i++) {
+				const double expected = ReaclibKernel::SetExponent(basis, kPar + 7 * i, kSetTypes[i]);
+				CHECK(exponents[i] == expected);
+				CHECK(logExponents[i] == expected);
+			}
+		}
+	}
+
+	/**Checks ReaclibKernel::EvaluateLog is the logarithm of Evaluate and stays
+	 * finite where the rate underflows, between the largest set exponent and
+	 * that plus the logarithm of the number of sets.
+	 */
+	void CheckLog(const std::vector<double> &grid, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets
+	) {
+		for (const double t9 : grid) {
+			const TemperatureBasis basis(t9);
+			const double logRate = ReaclibKernel::EvaluateLog(basis, par, setTypes, numSets);
+			const double rate = ReaclibKernel::Evaluate(basis, par, setTypes, numSets);
+			if (rate >= DBL_MIN) {
+				CHECK(std::fabs(logRate - log(rate)) <= 1e-13 * std::max(1., std::fabs(logRate)));
+				continue;
+			}
+			double maxExponent = -HUGE_VAL;
+			for (unsigned int i = 0; i < numSets; i++) {
+				maxExponent = std::max(maxExponent, 
+					ReaclibKernel::SetExponent(basis, par + 7 * i, setTypes[i]));
+			}
+			CHECK(std::isfinite(logRate));
+			CHECK(maxExponent <= logRate && logRate <= maxExponent + log(numSets));
+		}
+	}
+
+	/**Checks ReaclibKernel::EvaluateGradient against central differences in
+	 * each parameter, for the rate and for its logarithm. Changing a term a
+	 * set type skips evaluates the set in full, so those derivatives are
+	 * checked as well. The error is relative to the change of the rate for a
+	 * unit change of the exponent times the largest temperature term.
+	 */
+	void CheckGradient(const std::vector<double> &grid, const bool logScale) {
+		const double h = 1e-6;
+		double par[7 * kNumSets], grad[7 * kNumSets];
+		std::copy(kPar, kPar + 7 * kNumSets, par);
+		for (const double t9 : grid) {
+			const TemperatureBasis basis(t9);
+			const double value = ReaclibKernel::EvaluateGradient(basis, par, kSetTypes, 
+				kNumSets, grad, logScale);
+			const double scale = (logScale ? 1 : value) * std::max(1., basis[TemperatureBasis::kInverse]);
+			for (unsigned int i = 0; i < 7 * kNumSets; i++) {
+				par[i] = kPar[i] + h;
+				const double upper = logScale
+					? ReaclibKernel::EvaluateLog(basis, par, kSetTypes, kNumSets)
+					: ReaclibKernel::Evaluate(basis, par, kSetTypes, kNumSets);
+				par[i] = kPar[i] - h;
+				const double lower = logScale
+					? ReaclibKernel::EvaluateLog(basis, par, kSetTypes, kNumSets)
+					: ReaclibKernel::Evaluate(basis, par, kSetTypes, kNumSets);
+				par[i] = kPar[i];
+				CHECK(std::fabs((upper - lower) / (2 * h) - grad[i]) <= 1e-6 * scale);
+			}
+		}
+	}
+
+	/**Checks ReaclibKernel::EvaluateWithDerivative returns the rate of
+	 * Evaluate and a temperature derivative matching a central difference. The
+	 * rate may differ in the last bits, as Evaluate applies the T9^-3/2 of the
+	 * resonances outside the exponential. The error of the derivative is
+	 * relative to the rate over T9, as the derivative may vanish.
+	 */
+	void CheckDerivative(const std::vector<double> &grid, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets
+	) {
+		for (const double t9 : grid) {
+			const double h = 1e-6 * t9;
+			double derivative;
+			const double rate = ReaclibKernel::EvaluateWithDerivative(t9, par, setTypes, 
+				numSets, &derivative);
+			CHECK_CLOSE(rate, ReaclibKernel::Evaluate(t9, par, setTypes, numSets), 1e-12);
+			const double difference = (ReaclibKernel::Evaluate(t9 + h, par, setTypes, numSets)
+				- ReaclibKernel::Evaluate(t9 - h, par, setTypes, numSets)) / (2 * h);
+			CHECK(std::fabs(difference - derivative) <= 1e-6 * (std::fabs(derivative) + rate / t9));
+		}
+	}
+
+	/**Checks ReaclibKernel::EvaluateBatch agrees with the scalar Evaluate. The
+	 * exponents reach several hundred, so the last bit of the temperature
+	 * terms may add up to a few 1e-13. Values below DBL_MIN may be flushed to
+	 * zero by the vector exponential.
+	 */
+	void CheckBatch(const std::vector<double> &grid, const double *par, 
+		const ReaclibKernel::SetType *setTypes, const unsigned int numSets
+	) {
+		std::vector<double> batch(grid.size());
+		ReaclibKernel::EvaluateBatch(grid.data(), batch.data(), grid.size(), par, 
+			setTypes, numSets);
+		for (size_t i = 0; i < grid.size(); i++) {
+			const double expected = ReaclibKernel::Evaluate(grid[i], par, setTypes, numSets);
+			if (std::isinf(expected)) CHECK(batch[i] == expected);
+			else CHECK(std::fabs(batch[i] - expected) <= 1e-12 * expected + DBL_MIN);
+		}
+	}
+}
+
+int main() {
+	//Not a multiple of the block size, so the remainder path is used as well.
+	const std::vector<double> grid = MakeGrid(203);
+	CheckExponents(grid);
+	CheckLog(grid, kPar, kSetTypes, kNumSets);
+	//From 0.01 GK, where the step is still small against the 1 / T9 term.
+	const std::vector<double> fitGrid(grid.begin() + 51, grid.end());
+	CheckGradient(fitGrid, false);
+	CheckGradient(fitGrid, true);
+	CheckDerivative(fitGrid, kPar, kSetTypes, kNumSets);
+	CheckBatch(grid, kPar, kSetTypes, kNumSets);
+	//Each set alone, including a resonance underflowing below 0.005 GK.
+	for (unsigned int i = 0; i < kNumSets; i++) {
+		CheckLog(grid, kPar + 7 * i, kSetTypes + i, 1);
+		CheckDerivative(fitGrid, kPar + 7 * i, kSetTypes + i, 1);
+		CheckBatch(grid, kPar + 7 * i, kSetTypes + i, 1);
+	}
+
+	//A general set overflowing below about 0.01 GK and one underflowing to
+	//subnormal values and zero above it.
+	const double extreme[] = {
+		0, 7, 0, 0, 0, 0, 0,
+		0, -7, 0, 0, 0, 0, 0
+	};
+	const ReaclibKernel::SetType general[] = {ReaclibKernel::kGeneral, ReaclibKernel::kGeneral};
+	CheckBatch(grid, extreme, general, 1);
+	CheckBatch(grid, extreme + 7, general, 1);
+	CheckLog(grid, extreme + 7, general, 1);
+	CHECK_CLOSE(ReaclibKernel::EvaluateLog(0.001, extreme + 7, general, 1), -7000, 1e-15);
+	double rate;
+	const double t9 = 0.005;
+	ReaclibKernel::EvaluateBatch(&t9, &rate, 1, extreme, general, 1);
+	CHECK(std::isinf(rate));
+	ReaclibKernel::EvaluateBatch(&t9, &rate, 1, extreme + 7, general, 1);
+	CHECK(rate == 0);
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Generates tables from rates with zero, one and two resonances with 1 %
+ *  deviations and checks ReaclibModelSelector picks the true resonance count
+ *  with each information criterion, with and without uncertainties, even
+ *  though a candidate with more resonances fits as well or better.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibModelSelector.hpp"
+
+namespace {
+	/**Selects the resonance count of a table generated with the given number
+	 * of resonances, for every criterion with and without uncertainties.
+	 */
+	void CheckSelection(const unsigned int numResonances) {
+		const size_t n = 60;
+		const ReaclibModelSelector::Criterion criteria[] = {
+			ReaclibModelSelector::kAIC, ReaclibModelSelector::kAICc, ReaclibModelSelector::kBIC
+		};
+		ReaclibModel truth(numResonances, 6, 1, 12. / 13);
+		truth.SetSFactor(1.5e-3);
+		if (numResonances > 0) truth.SetResonance(0, 0.422, 8.6e-3);
+		if (numResonances > 1) truth.SetResonance(1, 1.1, 0.5);
+
+		//Reproducible deviations that do not follow any resonance.
+		std::vector<double> t9(n), rate(n), sigma(n);
+		for (size_t i = 0; i < n; i++) t9[i] = 0.05 * pow(100., i / (n - 1.));
+		truth.EvaluateBatch(t9.data(), rate.data(), n);
+		for (size_t i = 0; i < n; i++) {
+			rate[i] *= 1 + 0.01 * sin(7.3 * i);
+			sigma[i] = 0.01 * rate[i];
+		}
+
+		for (const ReaclibModelSelector::Criterion criterion : criteria) {
+			for (int weighted = 0; weighted < 2; weighted++) {
+				ReaclibModelSelector selector(6, 1, 12. / 13);
+				selector.SetCriterion(criterion);
+				const int selected = selector.Select(t9.data(), rate.data(),
+					weighted ? sigma.data() : 0, n);
+				CHECK(selected == static_cast<int>(numResonances));
+				CHECK(selector.GetNumCandidates() == 4);
+				if (selected != static_cast<int>(numResonances)) continue;
+
+				//The next candidate is within the tolerance and fits at least
+				//as well, so the penalty decided.
+				const ReaclibModelSelector::Candidate &chosen = selector.GetCandidate(selected);
+				const ReaclibModelSelector::Candidate &larger = selector.GetCandidate(selected + 1);
+				CHECK(chosen.success && larger.success);
+				CHECK(chosen.maxDeviation < 0.05 && larger.maxDeviation < 0.05);
+				CHECK(larger.result.chi2 <= chosen.result.chi2 * (1 + 1e-6));
+				CHECK(chosen.criterion < larger.criterion);
+				CHECK(selector.GetModel(selected).GetNumSets() == numResonances + 1);
+
+				//With uncertainties AIC adds twice the free parameters.
+				if (weighted && criterion == ReaclibModelSelector::kAIC) {
+					const double k = n - chosen.result.ndf;
+					CHECK_CLOSE(chosen.criterion, chosen.result.chi2 + 2 * k, 1e-12);
+				}
+			}
+		}
+	}
+}
+
+int main() {
+	for (unsigned int numResonances = 0; numResonances < 3; numResonances++) {
+		CheckSelection(numResonances);
+	}
+	return numFailures ? 1 : 0;
+}
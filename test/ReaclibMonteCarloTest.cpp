@@ -0,0 +1,78 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Propagates the uncertainty of a synthetic table with ReaclibMonteCarlo and
+ *  checks the percentile bands are ordered, do not depend on the batching and
+ *  are emptied by a run that fits nothing.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibMonteCarlo.hpp"
+
+int main() {
+	ReaclibModel model(1, 6, 1, 12. / 13);
+	model.SetSFactor(1.5e-3);
+	model.SetResonance(0, 0.422, 8.6e-3);
+	model.ReleaseParameter(0);
+	model.ReleaseParameter(7);
+
+	const size_t n = 30;
+	std::vector<double> t9(n), rate(n), factor(n, 1.2);
+	for (size_t i = 0; i < n; i++) t9[i] = 0.05 * pow(100., i / (n - 1.));
+	model.EvaluateBatch(t9.data(), rate.data(), n);
+
+	ReaclibMonteCarlo monteCarlo;
+	monteCarlo.SetNumSamples(200);
+	monteCarlo.SetBatchSize(64);
+	monteCarlo.SetSeed(7);
+	size_t numUpdates = 0;
+	CHECK(monteCarlo.Run(model, t9.data(), rate.data(), factor.data(), n,
+		[&](const ReaclibMonteCarlo::Bands &) {numUpdates++;}));
+	CHECK(numUpdates == 4);
+	const ReaclibMonteCarlo::Bands bands = monteCarlo.GetBands();
+	CHECK(bands.numSamples + bands.numFailed == 200);
+	CHECK(bands.numSamples > 190);
+
+	//The default percentiles are 2.5, 16, 50, 84 and 97.5 %.
+	const size_t numPercentiles = bands.percentiles.size();
+	CHECK(numPercentiles == 5);
+	const unsigned int numPar = bands.numParameters;
+	for (size_t p = 1; p < numPercentiles; p++) {
+		for (unsigned int i = 0; i < numPar; i++) {
+			CHECK(bands.parameters[(p - 1) * numPar + i] <= bands.parameters[p * numPar + i]);
+		}
+		for (size_t j = 0; j < n; j++) {
+			CHECK(bands.rate[(p - 1) * n + j] <= bands.rate[p * n + j]);
+		}
+	}
+	//A one sigma band of a 20 % factor uncertainty around the table.
+	for (size_t j = 0; j < n; j++) {
+		CHECK(bands.rate[1 * n + j] < rate[j] && rate[j] < bands.rate[3 * n + j]);
+		CHECK_CLOSE(bands.rate[2 * n + j], rate[j], 0.05);
+		CHECK_CLOSE(bands.rate[3 * n + j] / bands.rate[1 * n + j], 1.2 * 1.2, 0.05);
+	}
+
+	//All samples in one batch give the same bands.
+	monteCarlo.SetBatchSize(0);
+	CHECK(monteCarlo.Run(model, t9.data(), rate.data(), factor.data(), n));
+	CHECK(monteCarlo.GetBands().rate == bands.rate);
+	CHECK(monteCarlo.GetBands().parameters == bands.parameters);
+
+	//Percentiles outside [0, 1] are clamped to the extreme samples.
+	monteCarlo.SetPercentiles(std::vector<double>{-1, 0, 1, 2});
+	CHECK(monteCarlo.Run(model, t9.data(), rate.data(), factor.data(), n));
+	const std::vector<double> &clamped = monteCarlo.GetBands().rate;
+	CHECK(clamped[0] == clamped[n] && clamped[2 * n] == clamped[3 * n]);
+
+	//A run without samples reports no bands rather than those above.
+	monteCarlo.SetNumSamples(0);
+	CHECK(!monteCarlo.Run(model, t9.data(), rate.data(), factor.data(), n,
+		[](const ReaclibMonteCarlo::Bands &) {}));
+	CHECK(monteCarlo.GetBands().numSamples == 0);
+	CHECK(monteCarlo.GetBands().numFailed == 0);
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Fits a table with two resonances from initial energies far above the true
+ *  ones. A single fit stops in a local minimum, while ReaclibMultiStart must
+ *  find both resonances, with the same result for any number of threads.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibFitter.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibMultiStart.hpp"
+
+int main() {
+	ReaclibModel truth(2, 6, 1, 12. / 13);
+	truth.SetSFactor(1.5e-3);
+	truth.SetResonance(0, 0.422, 8.6e-3);
+	truth.SetResonance(1, 1.1, 0.5);
+
+	const size_t n = 60;
+	std::vector<double> t9(n), rate(n);
+	for (size_t i = 0; i < n; i++) t9[i] = 0.05 * pow(100., i / (n - 1.));
+	truth.EvaluateBatch(t9.data(), rate.data(), n);
+
+	ReaclibModel initial = truth;
+	initial.SetResonance(0, 2, 1e-3);
+	initial.SetResonance(1, 4, 1e-3);
+	for (unsigned int set = 1; set < 3; set++) {
+		initial.ReleaseParameter(7 * set);
+		initial.ReleaseParameter(7 * set + 1);
+	}
+
+	ReaclibModel single = initial;
+	ReaclibFitter fitter;
+	ReaclibFitter::Result singleResult;
+	CHECK(fitter.Fit(single, t9.data(), rate.data(), 0, n, &singleResult));
+	CHECK(singleResult.chi2 > 1);
+
+	ReaclibModel model = initial;
+	ReaclibMultiStart multiStart;
+	multiStart.SetNumStarts(64);
+	multiStart.SetNumThreads(4);
+	ReaclibFitter::Result result;
+	CHECK(multiStart.Fit(model, t9.data(), rate.data(), 0, n, &result));
+	CHECK(result.chi2 < 1e-16);
+	CHECK(multiStart.GetBestStart() > 0);
+	CHECK(multiStart.GetStartChi2().size() == 64);
+	//The first start is the unperturbed model.
+	CHECK(multiStart.GetStartChi2()[0] == singleResult.chi2);
+	CHECK(multiStart.GetErrors().size() == model.GetNumParameters());
+
+	//The resonances may be found in either order.
+	double energies[] = {model.GetParameter(8), model.GetParameter(15)};
+	std::sort(energies, energies + 2);
+	CHECK_CLOSE(energies[0], std::min(truth.GetParameter(8), truth.GetParameter(15)), 1e-6);
+	CHECK_CLOSE(energies[1], std::max(truth.GetParameter(8), truth.GetParameter(15)), 1e-6);
+	for (size_t i = 0; i < n; i++) CHECK_CLOSE(model.Evaluate(t9[i]), rate[i], 1e-6);
+
+	//The starts are seeded from their index, not from the thread.
+	ReaclibModel serial = initial;
+	multiStart.SetNumThreads(1);
+	ReaclibFitter::Result serialResult;
+	CHECK(multiStart.Fit(serial, t9.data(), rate.data(), 0, n, &serialResult));
+	CHECK(serialResult.chi2 == result.chi2);
+	for (unsigned int i = 0; i < model.GetNumParameters(); i++) {
+		CHECK(serial.GetParameter(i) == model.GetParameter(i));
+	}
+	return numFailures ? 1 : 0;
+}
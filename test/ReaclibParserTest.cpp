@@ -0,0 +1,137 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Writes rates with ReaclibWriter, reads them back with ReaclibParser and
+ *  checks the reactions, the resonance flags and the parameters survive. The
+ *  library read back is written again and must reproduce the file exactly.
+ *  A rate above ReaclibParser::kMaxSets must be rejected by the writer.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "RateLibrary.hpp"
+#include "ReaclibParser.hpp"
+#include "ReaclibWriter.hpp"
+
+namespace {
+	/**Returns the contents of a file, empty if it cannot be read.
+	 */
+	std::string ReadFile(const char *filename) {
+		std::string contents;
+		FILE *file = fopen(filename, "rb");
+		if (!file) return contents;
+		char buffer[4096];
+		size_t n;
+		while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) contents.append(buffer, n);
+		fclose(file);
+		return contents;
+	}
+}
+
+int main() {
+	const char *filename = "ReaclibParserTest.txt";
+	const char *refilename = "ReaclibParserTest2.txt";
+
+	//12C(p,g)13N with a non-resonant set and resonances flagged 'r' and 'w',
+	//the first with a general set, and its reverse rate.
+	const char *capture[] = {"c12", "p", "n13"};
+	const char *reverse[] = {"n13", "p", "c12"};
+	const char *tripleAlpha[] = {"he4", "he4", "he4", "c12"};
+	const double capturePar[] = {
+		17.1482, 0, -13.692, -0.230881, 4.44362, -3.15898, -0.666667,
+		17.5428, -3.77849, -5.10735, -2.24111, 0.148883, 0, -1.5,
+		-1.54567e-1, -4.25653, 2.1e-3, 0, 0, 0, -1.5
+	};
+	const double reversePar[] = {
+		40.4354, -26.326, -5.10735, -2.24111, 0.148883, 0, 0
+	};
+	const double tripleAlphaPar[] = {
+		-24.3505, -4.12656, -13.49, 21.4259, -1.34769, 0.0879816, -13.1653
+	};
+	const char captureFlags[] = {'n', 'r', 'w'};
+	const char tripleAlphaFlags[] = {'s'};
+
+	ReaclibWriter writer;
+	CHECK(writer.Open(filename));
+	CHECK(writer.WriteRate(ReaclibWriter::MakeReactionInfo(4, capture, 3, "ls09", 1.943),
+		capturePar, 3, 0, captureFlags));
+	CHECK(writer.WriteRate(ReaclibWriter::MakeReactionInfo(2, reverse, 3, "ls09", -1.943, true),
+		reversePar, 1));
+	CHECK(writer.WriteRate(ReaclibWriter::MakeReactionInfo(8, tripleAlpha, 4, "fy05", 7.275),
+		tripleAlphaPar, 1, 0, tripleAlphaFlags));
+	CHECK(writer.Close());
+
+	RateLibrary library;
+	ReaclibParser parser;
+	CHECK(parser.Load(filename, library));
+	CHECK(library.GetNumRates() == 3);
+	if (library.GetNumRates() != 3) return 1;
+
+	const double *expected[] = {capturePar, reversePar, tripleAlphaPar};
+	const unsigned int numSets[] = {3, 1, 1};
+	const char *labels[] = {"ls09", "ls09", "fy05"};
+	const char *flags[] = {captureFlags, "n", tripleAlphaFlags};
+	for (size_t r = 0; r < 3; r++) {
+		const ReactionInfo &info = library.GetReactionInfo(r);
+		CHECK(!strcmp(info.label, labels[r]));
+		CHECK((info.reverse == 'v') == (r == 1));
+		CHECK(library.GetNumSets(r) == numSets[r]);
+		if (library.GetNumSets(r) != numSets[r]) continue;
+		double par[21];
+		library.GetParameters(r, par);
+		for (unsigned int i = 0; i < 7 * numSets[r]; i++) {
+			CHECK(std::fabs(par[i] - expected[r][i]) <= 1e-6 * std::fabs(expected[r][i]));
+		}
+		for (unsigned int set = 0; set < numSets[r]; set++) {
+			CHECK(library.GetResonanceFlag(r, set) == flags[r][set]);
+		}
+	}
+	CHECK(!strcmp(library.GetReactionInfo(0).nuclides[2], "n13"));
+	CHECK(library.GetReactionInfo(2).chapter == 8);
+	CHECK_CLOSE(library.GetReactionInfo(2).qValue, 7.275, 1e-6);
+
+	CHECK(writer.Open(refilename));
+	CHECK(writer.WriteLibrary(library.GetView()));
+	CHECK(writer.Close());
+	const std::string contents = ReadFile(filename);
+	CHECK(!contents.empty());
+	CHECK(ReadFile(refilename) == contents);
+
+	//The largest rate the parser accepts round trips, a larger one is not
+	//written at all.
+	const unsigned int maxSets = ReaclibParser::kMaxSets;
+	std::vector<double> par(7 * (maxSets + 1), 0);
+	for (unsigned int set = 0; set <= maxSets; set++) {
+		par[7 * set] = -1. - set;
+		par[7 * set + 1] = -0.1 * set;
+		par[7 * set + 6] = -1.5;
+	}
+	const ReactionInfo info = ReaclibWriter::MakeReactionInfo(4, capture, 3, "many", 1.943);
+	CHECK(writer.Open(filename));
+	CHECK(writer.WriteRate(info, par.data(), maxSets));
+	CHECK(writer.Close());
+	RateLibrary large;
+	CHECK(parser.Load(filename, large));
+	CHECK(large.GetNumRates() == 1 && large.GetNumSets() == maxSets);
+
+	CHECK(writer.Open(filename));
+	CHECK(!writer.WriteRate(info, par.data(), maxSets + 1));
+	CHECK(!writer.Close());
+	CHECK(ReadFile(filename).empty());
+
+	large.AddRate(par.data(), maxSets + 1, 0, 0.01, 10, &info);
+	CHECK(writer.Open(filename));
+	CHECK(!writer.WriteLibrary(large.GetView()));
+	CHECK(!writer.Close());
+	RateLibrary reread;
+	CHECK(parser.Load(filename, reread));
+	CHECK(reread.GetNumRates() == 1 && reread.GetNumSets() == maxSets);
+
+	remove(filename);
+	remove(refilename);
+	return numFailures ? 1 : 0;
+}
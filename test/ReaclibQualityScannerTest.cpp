@@ -0,0 +1,60 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Scans a fit against the table it was generated from, then against the
+ *  same table with one point raised by half, and checks ReaclibQualityScanner
+ *  reports that point as the worst deviation. Invalid tables are rejected.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibModel.hpp"
+#include "ReaclibQualityScanner.hpp"
+
+int main() {
+	ReaclibModel model(1, 6, 1, 12. / 13);
+	model.SetSFactor(1.5e-3);
+	model.SetResonance(0, 0.422, 8.6e-3);
+
+	const size_t n = 200;
+	std::vector<double> t9(n), rate(n);
+	for (size_t i = 0; i < n; i++) t9[i] = 0.05 * pow(100., i / (n - 1.));
+	model.EvaluateBatch(t9.data(), rate.data(), n);
+
+	//Only the interpolation between the table points deviates.
+	ReaclibQualityScanner scanner;
+	ReaclibQualityScanner::Report clean;
+	CHECK(scanner.Scan(model, t9.data(), rate.data(), n, clean));
+	CHECK(clean.numPoints == 100000);
+	CHECK(clean.maxDeviation < 0.01);
+	CHECK(clean.rmsDeviation <= clean.maxDeviation);
+
+	//The raised point is on the grid and deviates by 1 - 1 / 1.5.
+	const size_t bad = 150;
+	rate[bad] *= 1.5;
+	ReaclibQualityScanner::Report report;
+	CHECK(scanner.Scan(model, t9.data(), rate.data(), n, report));
+	CHECK_CLOSE(report.maxDeviation, 1. / 3, 1e-3);
+	CHECK_CLOSE(report.worstT9, t9[bad], 1e-4);
+	CHECK_CLOSE(report.worstTable, rate[bad], 1e-3);
+	CHECK_CLOSE(report.worstFit, model.Evaluate(report.worstT9), 1e-12);
+	CHECK(report.rmsDeviation > clean.rmsDeviation);
+
+	//A grid that is not a multiple of the chunk size finds the same point.
+	scanner.SetNumPoints(10001);
+	CHECK(scanner.Scan(model, t9.data(), rate.data(), n, report));
+	CHECK(report.numPoints == 10001);
+	CHECK_CLOSE(report.worstT9, t9[bad], 1e-3);
+
+	//Too few points, temperatures out of order and a rate that is not positive.
+	CHECK(!scanner.Scan(model, t9.data(), rate.data(), 1, report));
+	std::swap(t9[3], t9[4]);
+	CHECK(!scanner.Scan(model, t9.data(), rate.data(), n, report));
+	std::swap(t9[3], t9[4]);
+	rate[bad] = 0;
+	CHECK(!scanner.Scan(model, t9.data(), rate.data(), n, report));
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+/** @file
+ *  @author Karl Smith
+ *
+ *  Checks that the unrolled ReaclibRateN::Evaluate agrees with the batched
+ *  and derivative evaluations, both for the structural layout and for a rate
+ *  whose non-resonant a1 and resonance a4 were released.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "Check.hpp"
+#include "ReaclibRateN.hpp"
+
+namespace {
+	/**Compares the scalar evaluation of the rate with the other paths over
+	 * temperatures from 0.01 to 10 GK.
+	 */
+	void CheckAgreement(const double *par) {
+		const ReaclibRateN<1> rate(par);
+		const size_t n = 50;
+		std::vector<double> t9(n), batch(n);
+		for (size_t i = 0; i < n; i++) t9[i] = 0.01 * pow(1000., i / (n - 1.));
+		rate.EvaluateBatch(t9.data(), batch.data(), n);
+		for (size_t i = 0; i < n; i++) {
+			double derivative;
+			const double value = rate.Evaluate(t9[i]);
+			CHECK_CLOSE(value, batch[i], 1e-12);
+			CHECK_CLOSE(value, rate.EvaluateWithDerivative(t9[i], &derivative), 1e-12);
+		}
+	}
+}
+
+int main() {
+	const double structural[] = {
+		-5, 0, -12, 1, 0.1, 0.01, -2. / 3,
+		3, -2, 0, 0, 0, 0, -1.5
+	};
+	CheckAgreement(structural);
+
+	const double released[] = {
+		-5, 0.3, -12, 1, 0.1, 0.01, -0.66666,
+		3, -2, 0.5, 0, 0, 0, -1.5
+	};
+	CheckAgreement(released);
+	//The value of the batched evaluation at 0.5 GK.
+	CHECK_CLOSE(ReaclibRateN<1>(released).Evaluate(0.5), 1.9536, 1e-4);
+
+	//Replacing the parameters switches between the two forms.
+	ReaclibRateN<1> rate(released);
+	rate.SetParameters(structural);
+	CHECK(rate.Evaluate(1.) == ReaclibRateN<1>(structural).Evaluate(1.));
+	rate.SetParameters(released);
+	CHECK_CLOSE(rate.Evaluate(0.5), 1.9536, 1e-4);
+	return numFailures ? 1 : 0;
+}